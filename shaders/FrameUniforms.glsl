@@ -0,0 +1,25 @@
+/* Constants of the frame and of the view drawn, see FrameUniforms. Blocks
+   bound once for every shader with UNIFORM_BUFFERS, plain uniforms set on
+   each shader otherwise */
+#ifdef UNIFORM_BUFFERS
+#define BLOCK_MEMBER
+layout(std140) uniform Frame {
+#else
+#define BLOCK_MEMBER uniform
+#endif
+    BLOCK_MEMBER highp mat4 shadowmapMatrix[MAX_SHADOWMAP_LEVELS];
+    BLOCK_MEMBER highp vec4 shadowDepthSplits[MAX_SHADOWMAP_LEVELS];
+    BLOCK_MEMBER highp vec3 light;
+    BLOCK_MEMBER highp float shininess;
+    BLOCK_MEMBER highp vec3 lightColor;
+    BLOCK_MEMBER highp vec3 ambientColor;
+#ifdef UNIFORM_BUFFERS
+};
+
+layout(std140) uniform View {
+#endif
+    BLOCK_MEMBER highp mat4 projectionMatrix;
+#ifdef UNIFORM_BUFFERS
+};
+#endif
+#undef BLOCK_MEMBER
@@ -1,8 +1,3 @@
-uniform highp vec3 light;
-uniform mediump vec3 ambientColor;
-uniform mediump vec3 lightColor;
-uniform mediump float shininess;
-
 uniform highp sampler2D lightmapTexture;
 uniform highp sampler2DArrayShadow shadowmapTexture;
 uniform highp sampler2D diffuseTexture;
@@ -15,7 +10,6 @@ in mediump vec2 interpolatedTextureCoords;
 
 #ifdef ENABLE_SHADOWMAP_LEVELS
 in highp vec3 shadowCoord[ENABLE_SHADOWMAP_LEVELS];
-uniform highp float shadowDepthSplits[ENABLE_SHADOWMAP_LEVELS];
 #endif
 
 in highp vec3 worldPos;
@@ -1,16 +1,48 @@
 uniform highp mat4 transformationMatrix;
 in highp vec4 position;
 
-#ifdef ENABLE_MAX_ANIMATION_BONES
+#ifdef JOINT_MATRICES_PER_ROW
 uniform uint perVertexJointCount;
-uniform mat4 jointMatrices[ENABLE_MAX_ANIMATION_BONES];
+#ifdef BAKED_ANIMATION
+/* Every clip sampled at a fixed rate, frame after frame of bakedJointCount
+   matrices from bakedClipOffset on */
+uniform highp sampler2D bakedAnimationTexture;
+uniform uint bakedClipOffset;
+uniform uint bakedJointCount;
+uniform uint bakedFrameCount;
+uniform highp float bakedFrame;
+#else
+/* Joint matrices of every character, four texels per matrix, the skin's
+   first one at jointMatrixOffset */
+uniform highp sampler2D jointMatrixTexture;
+uniform uint jointMatrixOffset;
+#endif
 
 layout(location = 6) in mediump uvec4 jointIds;
 layout(location = 7) in mediump vec4 weights;
+mat4 fetchMatrix(highp sampler2D matrices, uint matrix) {
+	int index = int(matrix);
+	ivec2 texel = ivec2((index % JOINT_MATRICES_PER_ROW)*4, index / JOINT_MATRICES_PER_ROW);
+	return mat4(texelFetch(matrices, texel, 0),
+	            texelFetch(matrices, texel + ivec2(1, 0), 0),
+	            texelFetch(matrices, texel + ivec2(2, 0), 0),
+	            texelFetch(matrices, texel + ivec2(3, 0), 0));
+}
+mat4 getJointMatrix(uint joint) {
+	#ifdef BAKED_ANIMATION
+	uint frame = uint(bakedFrame);
+	highp float t = bakedFrame - float(frame);
+	uint nextFrame = (frame + 1u) % bakedFrameCount;
+	return fetchMatrix(bakedAnimationTexture, bakedClipOffset + frame*bakedJointCount + joint)*(1.0 - t)
+	     + fetchMatrix(bakedAnimationTexture, bakedClipOffset + nextFrame*bakedJointCount + joint)*t;
+	#else
+	return fetchMatrix(jointMatrixTexture, jointMatrixOffset + joint);
+	#endif
+}
 mat4 getSkinMatrix() {
 	mat4 skinMatrix = mat4(0.0);
 	for(uint i = 0u; i != perVertexJointCount; ++i) {
-		skinMatrix += weights[i]*jointMatrices[jointIds[i]];
+		skinMatrix += weights[i]*getJointMatrix(jointIds[i]);
 	}
 	return skinMatrix;
 }
@@ -20,11 +52,11 @@ void main()
 {
 	vec4 modelPosition = position;
 
-	#ifdef ENABLE_MAX_ANIMATION_BONES
+	#ifdef JOINT_MATRICES_PER_ROW
     if (perVertexJointCount > 0u) {
 		modelPosition = getSkinMatrix() * modelPosition;
 	}
 	#endif
 
-	gl_Position = transformationMatrix * modelPosition;
+	gl_Position = projectionMatrix * transformationMatrix * modelPosition;
 }
@@ -0,0 +1,3 @@
+/* Never runs, the skinning pass discards its points before rasterization */
+void main() {
+}
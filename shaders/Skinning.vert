@@ -0,0 +1,34 @@
+/* Skins every vertex of a mesh once, captured with transform feedback into
+   a buffer the main and shadow passes then draw without skinning */
+layout(location = 0) in highp vec3 position;
+layout(location = 5) in highp vec3 normal;
+layout(location = 6) in mediump uvec4 jointIds;
+layout(location = 7) in mediump vec4 weights;
+
+uniform uint perVertexJointCount;
+/* Joint matrices of every character, four texels per matrix, the skin's
+   first one at jointMatrixOffset */
+uniform highp sampler2D jointMatrixTexture;
+uniform uint jointMatrixOffset;
+
+out highp vec3 skinnedPosition;
+out highp vec3 skinnedNormal;
+
+mat4 getJointMatrix(uint joint) {
+    int index = int(jointMatrixOffset + joint);
+    ivec2 texel = ivec2((index % JOINT_MATRICES_PER_ROW)*4, index / JOINT_MATRICES_PER_ROW);
+    return mat4(texelFetch(jointMatrixTexture, texel, 0),
+                texelFetch(jointMatrixTexture, texel + ivec2(1, 0), 0),
+                texelFetch(jointMatrixTexture, texel + ivec2(2, 0), 0),
+                texelFetch(jointMatrixTexture, texel + ivec2(3, 0), 0));
+}
+
+void main() {
+    mat4 skinMatrix = mat4(0.0);
+    for(uint i = 0u; i != perVertexJointCount; ++i) {
+        skinMatrix += weights[i]*getJointMatrix(jointIds[i]);
+    }
+
+    skinnedPosition = (skinMatrix * vec4(position, 1.0)).xyz;
+    skinnedNormal = mat3(skinMatrix) * normal;
+}
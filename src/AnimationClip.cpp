@@ -0,0 +1,443 @@
+#include "AnimationClip.h"
+
+#include <algorithm>
+#include <cmath>
+#include <Corrade/Containers/GrowableArray.h>
+#include <Corrade/Containers/StridedArrayView.h>
+#include <Corrade/Utility/Debug.h>
+#include <Magnum/Animation/Interpolation.h>
+#include <Magnum/Math/CubicHermite.h>
+#include <Magnum/Math/Functions.h>
+#include <Magnum/Math/Range.h>
+#include <Magnum/Trade/AnimationData.h>
+
+namespace MagnumGame {
+
+    namespace {
+        struct TrackRef {
+            UnsignedInt bone;
+            UnsignedInt track;
+        };
+
+        /* Key values of a track with the cubic tangents dropped, those only
+           appear with cubic spline exports which this doesn't interpolate */
+        template<class T> T keyValue(const Trade::AnimationData& animation, UnsignedInt track, std::size_t key);
+
+        template<> Vector3 keyValue(const Trade::AnimationData& animation, UnsignedInt track, std::size_t key) {
+            if (animation.trackType(track) == Trade::AnimationTrackType::CubicHermite3D) {
+                return animation.track<CubicHermite3D>(track).values()[key].point();
+            }
+            return animation.track<Vector3>(track).values()[key];
+        }
+
+        template<> Quaternion keyValue(const Trade::AnimationData& animation, UnsignedInt track, std::size_t key) {
+            if (animation.trackType(track) == Trade::AnimationTrackType::CubicHermiteQuaternion) {
+                return animation.track<CubicHermiteQuaternion>(track).values()[key].point();
+            }
+            return animation.track<Quaternion>(track).values()[key];
+        }
+
+        template<class T> Containers::Array<T> flattenKeyMajor(const Trade::AnimationData& animation, const SkeletonAsset& skeleton,
+                                                              std::size_t keyCount, Containers::ArrayView<TrackRef> tracks,
+                                                              Containers::Array<UnsignedInt>& bones, std::size_t& reducedCount) {
+            auto depths = skeleton.getDepths();
+            auto isDeep = [&](const TrackRef& track) { return depths[track.bone] > AnimationClip::ReducedBoneDepth; };
+            std::sort(tracks.begin(), tracks.end(), [&](const TrackRef& a, const TrackRef& b) {
+                if (isDeep(a) != isDeep(b)) return isDeep(b);
+                return a.bone < b.bone;
+            });
+            reducedCount = std::size_t(std::count_if(tracks.begin(), tracks.end(), [&](const TrackRef& track) { return !isDeep(track); }));
+            bones = Containers::Array<UnsignedInt>{NoInit, tracks.size()};
+            for (std::size_t i = 0; i < tracks.size(); i++) bones[i] = tracks[i].bone;
+
+            Containers::Array<T> values{NoInit, keyCount * tracks.size()};
+            for (std::size_t key = 0; key < keyCount; key++) {
+                for (std::size_t i = 0; i < tracks.size(); i++) {
+                    values[key * tracks.size() + i] = keyValue<T>(animation, tracks[i].track, key);
+                }
+            }
+            return values;
+        }
+
+        constexpr Float QuantizedMax = 65535.0f;
+        constexpr Float RotationMax = 32767.0f;
+
+        /* Range of track @p track over all keys of a key-major array */
+        void trackRange(Containers::ArrayView<const Vector3> values, std::size_t trackCount, std::size_t track,
+                        Vector3& min, Vector3& step) {
+            Range3D range{values[track], values[track]};
+            for (std::size_t i = track + trackCount; i < values.size(); i += trackCount) {
+                range = Math::join(range, Range3D{values[i], values[i]});
+            }
+            min = range.min();
+            step = range.size() / QuantizedMax;
+        }
+
+        Vector3us quantize(const Vector3& value, const Vector3& min, const Vector3& step) {
+            Vector3us packed;
+            for (std::size_t i = 0; i < 3; i++) {
+                packed[i] = step[i] > 0.0f ? UnsignedShort(Math::clamp(Math::round((value[i] - min[i]) / step[i]), 0.0f, QuantizedMax)) : 0;
+            }
+            return packed;
+        }
+
+        Vector3 dequantize(const Vector3us& packed, const Vector3& min, const Vector3& step) {
+            return min + Vector3{packed} * step;
+        }
+
+        /* Smallest three: the largest component is left out and recomputed
+           from the unit length, the other three are within ±1/√2. The top
+           bits of the first two values hold which component was left out,
+           the top bit of the third whether the quaternion was negated to make
+           the left out component positive, so the hemisphere picked on load
+           survives */
+        Vector3us packRotation(const Quaternion& rotation) {
+            Vector4 components{rotation.vector(), rotation.scalar()};
+            std::size_t largest = 0;
+            for (std::size_t i = 1; i < 4; i++) {
+                if (Math::abs(components[i]) > Math::abs(components[largest])) largest = i;
+            }
+            const bool negated = components[largest] < 0.0f;
+            if (negated) components = -components;
+
+            Vector3us packed;
+            for (std::size_t i = 0, j = 0; i < 4; i++) {
+                if (i == largest) continue;
+                const Float normalized = components[i] * Constants::sqrt2() * 0.5f + 0.5f;
+                packed[j++] = UnsignedShort(Math::clamp(Math::round(normalized * RotationMax), 0.0f, RotationMax));
+            }
+            packed[0] |= UnsignedShort((largest & 1) << 15);
+            packed[1] |= UnsignedShort((largest >> 1) << 15);
+            packed[2] |= UnsignedShort(UnsignedInt(negated) << 15);
+            return packed;
+        }
+
+        /* Not exactly unit length, the sampler normalizes after nlerp anyway */
+        Quaternion unpackRotation(const Vector3us& packed) {
+            const std::size_t largest = (packed[0] >> 15) | ((packed[1] >> 15) << 1);
+            Vector3 smallest;
+            for (std::size_t i = 0; i < 3; i++) {
+                smallest[i] = (Float(packed[i] & 0x7fff) * (2.0f / RotationMax) - 1.0f) * (1.0f / Constants::sqrt2());
+            }
+
+            Vector4 components;
+            for (std::size_t i = 0, j = 0; i < 4; i++) {
+                components[i] = i == largest ? std::sqrt(Math::max(1.0f - smallest.dot(), 0.0f)) : smallest[j++];
+            }
+            if (packed[2] >> 15) components = -components;
+            return Quaternion{components.xyz(), components.w()};
+        }
+
+        Float rotationError(const Quaternion& a, const Quaternion& b) {
+            return 2.0f * std::acos(Math::min(Math::abs(Math::dot(a.normalized(), b.normalized())), 1.0f));
+        }
+    }
+
+    AnimationClip::AnimationClip(const Trade::AnimationData &animation, const SkeletonAsset &skeleton)
+        : _duration{animation.duration()} {
+
+        struct ChannelTracks {
+            Containers::Array<TrackRef> translations, rotations, scalings;
+        };
+        Containers::Array<ChannelTracks> channelTracks;
+
+        for (UnsignedInt track = 0; track != animation.trackCount(); track++) {
+            auto bone = skeleton.getBoneForObject(animation.trackTarget(track));
+            if (bone == -1) {
+                Warning{} << "Animation track" << track << "targets" << animation.trackTarget(track) << "which isn't a bone";
+                continue;
+            }
+
+            auto keys = animation.track(track).keys();
+            bool constant = animation.track(track).interpolation() == Animation::Interpolation::Constant;
+
+            /* Blender exports baked tracks with the same keys for every bone,
+               so there's usually a single channel */
+            std::size_t channel = 0;
+            for (; channel < _channels.size(); channel++) {
+                auto& channelKeys = _channels[channel].keys;
+                if (_channels[channel].constant != constant || channelKeys.size() != keys.size()) continue;
+                if (std::equal(channelKeys.begin(), channelKeys.end(), keys.begin())) break;
+            }
+            if (channel == _channels.size()) {
+                auto& newChannel = arrayAppend(_channels, InPlaceInit);
+                newChannel.keys = Containers::Array<Float>{NoInit, keys.size()};
+                for (std::size_t key = 0; key < keys.size(); key++) newChannel.keys[key] = keys[key];
+                newChannel.constant = constant;
+                arrayAppend(channelTracks, InPlaceInit);
+            }
+
+            switch (animation.trackTargetName(track)) {
+                case Trade::AnimationTrackTarget::Translation3D:
+                    arrayAppend(channelTracks[channel].translations, TrackRef{UnsignedInt(bone), track});
+                    break;
+                case Trade::AnimationTrackTarget::Rotation3D:
+                    arrayAppend(channelTracks[channel].rotations, TrackRef{UnsignedInt(bone), track});
+                    break;
+                case Trade::AnimationTrackTarget::Scaling3D:
+                    arrayAppend(channelTracks[channel].scalings, TrackRef{UnsignedInt(bone), track});
+                    break;
+                default:
+                    Warning{} << "Ignoring animation track" << track << "of" << animation.trackTargetName(track);
+                    continue;
+            }
+            _trackCount++;
+        }
+
+        for (std::size_t c = 0; c < _channels.size(); c++) {
+            auto& channel = _channels[c];
+            auto keyCount = channel.keys.size();
+            channel.translations = flattenKeyMajor<Vector3>(animation, skeleton, keyCount, channelTracks[c].translations,
+                                                            channel.translationBones, channel.reducedTranslationCount);
+            channel.rotations = flattenKeyMajor<Quaternion>(animation, skeleton, keyCount, channelTracks[c].rotations,
+                                                            channel.rotationBones, channel.reducedRotationCount);
+            channel.scalings = flattenKeyMajor<Vector3>(animation, skeleton, keyCount, channelTracks[c].scalings,
+                                                        channel.scalingBones, channel.reducedScalingCount);
+
+            /* q and -q are the same rotation, pick the one closer to the
+               previous key so nlerp always takes the shortest path */
+            auto rotationCount = channel.rotationBones.size();
+            for (std::size_t key = 1; key < keyCount; key++) {
+                for (std::size_t i = 0; i < rotationCount; i++) {
+                    auto& rotation = channel.rotations[key * rotationCount + i];
+                    if (Math::dot(rotation, channel.rotations[(key - 1) * rotationCount + i]) < 0.0f) rotation = -rotation;
+                }
+            }
+        }
+    }
+
+    void AnimationClip::findKeys(const Channel &channel, Float time, std::size_t &first, std::size_t &second, Float &t) {
+        first = second = 0;
+        t = 0.0f;
+        if (time >= channel.keys.back()) {
+            first = second = channel.keys.size() - 1;
+        } else if (time > channel.keys.front()) {
+            second = std::size_t(std::upper_bound(channel.keys.begin(), channel.keys.end(), time) - channel.keys.begin());
+            first = second - 1;
+            if (!channel.constant) t = (time - channel.keys[first]) / (channel.keys[second] - channel.keys[first]);
+        }
+    }
+
+    void AnimationClip::sample(Float time, SkeletonPose &pose, bool reduced) const {
+        auto translations = pose.translations();
+        auto rotations = pose.rotations();
+        auto scalings = pose.scalings();
+
+        for (auto& channel : _channels) {
+            if (channel.keys.isEmpty()) continue;
+
+            /* One keyframe search for every track of the channel */
+            std::size_t first, second;
+            Float t;
+            findKeys(channel, time, first, second, t);
+            if (_compressed) {
+                sampleCompressed(channel, first, second, t, pose, reduced);
+                continue;
+            }
+
+            const std::size_t translationCount = channel.translationBones.size();
+            const Vector3* translationsA = channel.translations.data() + first * translationCount;
+            const Vector3* translationsB = channel.translations.data() + second * translationCount;
+            const std::size_t translationEnd = reduced ? channel.reducedTranslationCount : translationCount;
+            for (std::size_t i = 0; i < translationEnd; i++) {
+                translations[channel.translationBones[i]] = translationsA[i] + (translationsB[i] - translationsA[i]) * t;
+            }
+
+            const std::size_t rotationCount = channel.rotationBones.size();
+            const Quaternion* rotationsA = channel.rotations.data() + first * rotationCount;
+            const Quaternion* rotationsB = channel.rotations.data() + second * rotationCount;
+            const std::size_t rotationEnd = reduced ? channel.reducedRotationCount : rotationCount;
+            for (std::size_t i = 0; i < rotationEnd; i++) {
+                rotations[channel.rotationBones[i]] = (rotationsA[i] * (1.0f - t) + rotationsB[i] * t).normalized();
+            }
+
+            const std::size_t scalingCount = channel.scalingBones.size();
+            const Vector3* scalingsA = channel.scalings.data() + first * scalingCount;
+            const Vector3* scalingsB = channel.scalings.data() + second * scalingCount;
+            const std::size_t scalingEnd = reduced ? channel.reducedScalingCount : scalingCount;
+            for (std::size_t i = 0; i < scalingEnd; i++) {
+                scalings[channel.scalingBones[i]] = scalingsA[i] + (scalingsB[i] - scalingsA[i]) * t;
+            }
+        }
+    }
+
+    void AnimationClip::sampleCompressed(const Channel &channel, std::size_t first, std::size_t second, Float t,
+                                         SkeletonPose &pose, bool reduced) {
+        auto translations = pose.translations();
+        auto rotations = pose.rotations();
+        auto scalings = pose.scalings();
+
+        const std::size_t translationCount = channel.translationBones.size();
+        const Vector3us* translationsA = channel.packedTranslations.data() + first * translationCount;
+        const Vector3us* translationsB = channel.packedTranslations.data() + second * translationCount;
+        const std::size_t translationEnd = reduced ? channel.reducedTranslationCount : translationCount;
+        for (std::size_t i = 0; i < translationEnd; i++) {
+            const auto& track = channel.translationTracks[i];
+            const Vector3 a = dequantize(translationsA[i], track.min, track.step);
+            const Vector3 b = dequantize(translationsB[i], track.min, track.step);
+            translations[channel.translationBones[i]] = a + (b - a) * t;
+        }
+
+        const std::size_t rotationCount = channel.rotationBones.size();
+        const Vector3us* rotationsA = channel.packedRotations.data() + first * rotationCount;
+        const Vector3us* rotationsB = channel.packedRotations.data() + second * rotationCount;
+        const std::size_t rotationEnd = reduced ? channel.reducedRotationCount : rotationCount;
+        for (std::size_t i = 0; i < rotationEnd; i++) {
+            rotations[channel.rotationBones[i]] = (unpackRotation(rotationsA[i]) * (1.0f - t) + unpackRotation(rotationsB[i]) * t).normalized();
+        }
+
+        const std::size_t scalingCount = channel.scalingBones.size();
+        const Vector3us* scalingsA = channel.packedScalings.data() + first * scalingCount;
+        const Vector3us* scalingsB = channel.packedScalings.data() + second * scalingCount;
+        const std::size_t scalingEnd = reduced ? channel.reducedScalingCount : scalingCount;
+        for (std::size_t i = 0; i < scalingEnd; i++) {
+            const auto& track = channel.scalingTracks[i];
+            const Vector3 a = dequantize(scalingsA[i], track.min, track.step);
+            const Vector3 b = dequantize(scalingsB[i], track.min, track.step);
+            scalings[channel.scalingBones[i]] = a + (b - a) * t;
+        }
+    }
+
+    AnimationClip::CompressionResult AnimationClip::compress(const AnimationCompression &compression) {
+        CompressionResult result{};
+        result.originalByteSize = getByteSize();
+        if (_compressed) {
+            result.byteSize = result.originalByteSize;
+            for (auto& channel : _channels) result.originalKeyCount += UnsignedInt(channel.keys.size());
+            result.keyCount = result.originalKeyCount;
+            return result;
+        }
+
+        for (auto& channel : _channels) {
+            const std::size_t keyCount = channel.keys.size();
+            const std::size_t translationCount = channel.translationBones.size();
+            const std::size_t rotationCount = channel.rotationBones.size();
+            const std::size_t scalingCount = channel.scalingBones.size();
+            result.originalKeyCount += UnsignedInt(keyCount);
+
+            /* Whether every track between @p a and @p b is reproduced within
+               tolerance by interpolating those two keys */
+            auto canSkipBetween = [&](std::size_t a, std::size_t b) {
+                for (std::size_t key = a + 1; key < b; key++) {
+                    const Float t = channel.constant ? 0.0f : (channel.keys[key] - channel.keys[a]) / (channel.keys[b] - channel.keys[a]);
+                    for (std::size_t i = 0; i < translationCount; i++) {
+                        const Vector3 from = channel.translations[a * translationCount + i];
+                        const Vector3 to = channel.translations[b * translationCount + i];
+                        if (Math::abs(from + (to - from) * t - channel.translations[key * translationCount + i]).max() > compression.translationTolerance) return false;
+                    }
+                    for (std::size_t i = 0; i < rotationCount; i++) {
+                        const Quaternion from = channel.rotations[a * rotationCount + i];
+                        const Quaternion to = channel.rotations[b * rotationCount + i];
+                        if (rotationError(from * (1.0f - t) + to * t, channel.rotations[key * rotationCount + i]) > compression.rotationTolerance) return false;
+                    }
+                    for (std::size_t i = 0; i < scalingCount; i++) {
+                        const Vector3 from = channel.scalings[a * scalingCount + i];
+                        const Vector3 to = channel.scalings[b * scalingCount + i];
+                        if (Math::abs(from + (to - from) * t - channel.scalings[key * scalingCount + i]).max() > compression.scalingTolerance) return false;
+                    }
+                }
+                return true;
+            };
+
+            /* Greedily stretch every segment as far as it stays within
+               tolerance, the first and last key always stay */
+            Containers::Array<UnsignedInt> keptKeys;
+            if (keyCount) arrayAppend(keptKeys, 0u);
+            for (std::size_t anchor = 0, key = 2; key < keyCount; key++) {
+                if (!canSkipBetween(anchor, key)) {
+                    anchor = key - 1;
+                    arrayAppend(keptKeys, UnsignedInt(anchor));
+                }
+            }
+            if (keyCount > 1) arrayAppend(keptKeys, UnsignedInt(keyCount - 1));
+
+            Channel compressed;
+            compressed.constant = channel.constant;
+            compressed.translationBones = std::move(channel.translationBones);
+            compressed.rotationBones = std::move(channel.rotationBones);
+            compressed.scalingBones = std::move(channel.scalingBones);
+            compressed.reducedTranslationCount = channel.reducedTranslationCount;
+            compressed.reducedRotationCount = channel.reducedRotationCount;
+            compressed.reducedScalingCount = channel.reducedScalingCount;
+            compressed.keys = Containers::Array<Float>{NoInit, keptKeys.size()};
+            compressed.translationTracks = Containers::Array<QuantizedTrack>{NoInit, translationCount};
+            compressed.scalingTracks = Containers::Array<QuantizedTrack>{NoInit, scalingCount};
+            compressed.packedTranslations = Containers::Array<Vector3us>{NoInit, keptKeys.size() * translationCount};
+            compressed.packedRotations = Containers::Array<Vector3us>{NoInit, keptKeys.size() * rotationCount};
+            compressed.packedScalings = Containers::Array<Vector3us>{NoInit, keptKeys.size() * scalingCount};
+
+            for (std::size_t i = 0; i < translationCount; i++) {
+                trackRange(channel.translations, translationCount, i, compressed.translationTracks[i].min, compressed.translationTracks[i].step);
+            }
+            for (std::size_t i = 0; i < scalingCount; i++) {
+                trackRange(channel.scalings, scalingCount, i, compressed.scalingTracks[i].min, compressed.scalingTracks[i].step);
+            }
+            for (std::size_t kept = 0; kept < keptKeys.size(); kept++) {
+                const std::size_t key = keptKeys[kept];
+                compressed.keys[kept] = channel.keys[key];
+                for (std::size_t i = 0; i < translationCount; i++) {
+                    const auto& track = compressed.translationTracks[i];
+                    compressed.packedTranslations[kept * translationCount + i] = quantize(channel.translations[key * translationCount + i], track.min, track.step);
+                }
+                for (std::size_t i = 0; i < rotationCount; i++) {
+                    compressed.packedRotations[kept * rotationCount + i] = packRotation(channel.rotations[key * rotationCount + i]);
+                }
+                for (std::size_t i = 0; i < scalingCount; i++) {
+                    const auto& track = compressed.scalingTracks[i];
+                    compressed.packedScalings[kept * scalingCount + i] = quantize(channel.scalings[key * scalingCount + i], track.min, track.step);
+                }
+            }
+            result.keyCount += UnsignedInt(keptKeys.size());
+
+            /* Decode at every original key, linear interpolation can't be
+               further off anywhere in between */
+            for (std::size_t key = 0; key < keyCount; key++) {
+                std::size_t first, second;
+                Float t;
+                findKeys(compressed, channel.keys[key], first, second, t);
+                for (std::size_t i = 0; i < translationCount; i++) {
+                    const auto& track = compressed.translationTracks[i];
+                    const Vector3 a = dequantize(compressed.packedTranslations[first * translationCount + i], track.min, track.step);
+                    const Vector3 b = dequantize(compressed.packedTranslations[second * translationCount + i], track.min, track.step);
+                    result.maxTranslationError = Math::max(result.maxTranslationError, Math::abs(a + (b - a) * t - channel.translations[key * translationCount + i]).max());
+                }
+                for (std::size_t i = 0; i < rotationCount; i++) {
+                    const Quaternion a = unpackRotation(compressed.packedRotations[first * rotationCount + i]);
+                    const Quaternion b = unpackRotation(compressed.packedRotations[second * rotationCount + i]);
+                    result.maxRotationError = Math::max(result.maxRotationError, rotationError(a * (1.0f - t) + b * t, channel.rotations[key * rotationCount + i]));
+                }
+                for (std::size_t i = 0; i < scalingCount; i++) {
+                    const auto& track = compressed.scalingTracks[i];
+                    const Vector3 a = dequantize(compressed.packedScalings[first * scalingCount + i], track.min, track.step);
+                    const Vector3 b = dequantize(compressed.packedScalings[second * scalingCount + i], track.min, track.step);
+                    result.maxScalingError = Math::max(result.maxScalingError, Math::abs(a + (b - a) * t - channel.scalings[key * scalingCount + i]).max());
+                }
+            }
+
+            channel = std::move(compressed);
+        }
+
+        _compressed = true;
+        result.byteSize = getByteSize();
+        return result;
+    }
+
+    std::size_t AnimationClip::getByteSize() const {
+        std::size_t size = sizeof(AnimationClip) + _channels.size() * sizeof(Channel);
+        for (auto& channel : _channels) {
+            size += channel.keys.size() * sizeof(Float)
+                  + (channel.translationBones.size() + channel.rotationBones.size() + channel.scalingBones.size()) * sizeof(UnsignedInt)
+                  + channel.translations.size() * sizeof(Vector3)
+                  + channel.rotations.size() * sizeof(Quaternion)
+                  + channel.scalings.size() * sizeof(Vector3)
+                  + (channel.translationTracks.size() + channel.scalingTracks.size()) * sizeof(QuantizedTrack)
+                  + (channel.packedTranslations.size() + channel.packedRotations.size() + channel.packedScalings.size()) * sizeof(Vector3us);
+        }
+        return size;
+    }
+
+    void AnimationClip::sampleLooped(Float elapsed, SkeletonPose &pose, bool reduced) const {
+        auto length = _duration.size();
+        sample(_duration.min() + (length > 0.0f ? std::fmod(elapsed, length) : 0.0f), pose, reduced);
+    }
+}
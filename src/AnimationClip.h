@@ -0,0 +1,124 @@
+#pragma once
+
+#include <Corrade/Containers/Array.h>
+#include <Magnum/Math/Quaternion.h>
+#include <Magnum/Math/Range.h>
+#include <Magnum/Trade/Trade.h>
+
+#include "MagnumGameCommon.h"
+#include "SkeletonAsset.h"
+
+namespace MagnumGame {
+
+    /* Largest error AnimationClip::compress() may add by dropping keys,
+       quantizing adds at most a few thousandths of that on top */
+    struct AnimationCompression {
+        /* In scene units */
+        Float translationTolerance = 0.0005f;
+        /* Angle in radians */
+        Float rotationTolerance = 0.001f;
+        Float scalingTolerance = 0.0005f;
+    };
+
+    /**
+     * @brief All tracks of an animation, sampled together into a SkeletonPose
+     *
+     * Tracks with the same keyframe times share a channel, so a sample does
+     * one keyframe search per channel rather than per track. Channel values
+     * are stored key-major, all tracks of the first key followed by all
+     * tracks of the second, so interpolating a channel is a plain loop over
+     * two contiguous runs. Rotations are nlerped, with consecutive keys
+     * flipped to the same hemisphere on load so the loop needs no shortest
+     * path check. A clip can be compressed once after loading, which drops
+     * keys that interpolation reproduces within a tolerance and quantizes
+     * the values, decoding them as it samples. Immutable after that, one
+     * clip is shared by every character playing it. Holds no GL state.
+     */
+    class AnimationClip {
+    public:
+        /* Bones nested deeper than this, such as fingers, are skipped by a
+           reduced sample(). Read when a clip is loaded */
+        inline static UnsignedInt ReducedBoneDepth = 5;
+
+        struct CompressionResult {
+            std::size_t originalByteSize;
+            std::size_t byteSize;
+            UnsignedInt originalKeyCount;
+            UnsignedInt keyCount;
+            /* Measured at every original key */
+            Float maxTranslationError;
+            Float maxRotationError;
+            Float maxScalingError;
+
+            Float getRatio() const { return Float(originalByteSize) / Float(byteSize); }
+        };
+
+        explicit AnimationClip(const Trade::AnimationData& animation, const SkeletonAsset& skeleton);
+
+        /* Replaces the float keyframes with the compressed ones, translations
+           and scalings as 16 bits per component within the range of their
+           track, rotations as the smallest three components in 15 bits each */
+        CompressionResult compress(const AnimationCompression& compression);
+
+        bool isCompressed() const { return _compressed; }
+
+        /* Key time range of the animation, which doesn't have to start at 0 */
+        const Range1D& getDuration() const { return _duration; }
+
+        UnsignedInt getChannelCount() const { return UnsignedInt(_channels.size()); }
+        UnsignedInt getTrackCount() const { return _trackCount; }
+
+        /* Keyframe memory, shared by everyone playing the clip */
+        std::size_t getByteSize() const;
+
+        /* Writes every animated bone of @p pose at @p time, clamped to the
+           duration. Bones without a track are left alone, and so are bones
+           deeper than ReducedBoneDepth if @p reduced is set */
+        void sample(Float time, SkeletonPose& pose, bool reduced = false) const;
+
+        /* Samples the clip looped, @p elapsed seconds after it started */
+        void sampleLooped(Float elapsed, SkeletonPose& pose, bool reduced = false) const;
+
+    private:
+        /* Decoded as min + step*value, step being the track range / 65535 */
+        struct QuantizedTrack {
+            Vector3 min;
+            Vector3 step;
+        };
+
+        struct Channel {
+            Containers::Array<Float> keys;
+            bool constant;
+            /* Bones up to ReducedBoneDepth first, each part sorted so the
+               writes into the pose go forward */
+            Containers::Array<UnsignedInt> translationBones;
+            Containers::Array<UnsignedInt> rotationBones;
+            Containers::Array<UnsignedInt> scalingBones;
+            /* How many of the above are up to ReducedBoneDepth */
+            std::size_t reducedTranslationCount;
+            std::size_t reducedRotationCount;
+            std::size_t reducedScalingCount;
+            /* keys.size()*translationBones.size() values, key-major */
+            Containers::Array<Vector3> translations;
+            Containers::Array<Quaternion> rotations;
+            Containers::Array<Vector3> scalings;
+            /* Replace the three above once compressed, in the same order */
+            Containers::Array<QuantizedTrack> translationTracks;
+            Containers::Array<QuantizedTrack> scalingTracks;
+            Containers::Array<Vector3us> packedTranslations;
+            Containers::Array<Vector3us> packedRotations;
+            Containers::Array<Vector3us> packedScalings;
+        };
+
+        /* Keys around @p time and the interpolation factor between them */
+        static void findKeys(const Channel& channel, Float time, std::size_t& first, std::size_t& second, Float& t);
+
+        static void sampleCompressed(const Channel& channel, std::size_t first, std::size_t second, Float t,
+                                     SkeletonPose& pose, bool reduced);
+
+        Containers::Array<Channel> _channels;
+        Range1D _duration;
+        UnsignedInt _trackCount{};
+        bool _compressed{};
+    };
+}
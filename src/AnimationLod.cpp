@@ -0,0 +1,31 @@
+#include "AnimationLod.h"
+
+#include <Magnum/Math/Intersection.h>
+
+namespace MagnumGame {
+
+    AnimationLod::AnimationLod(const Matrix4 &cameraMatrix, const Matrix4 &projectionMatrix)
+        : _cameraMatrix{cameraMatrix},
+          _frustum{Frustum::fromMatrix(projectionMatrix * cameraMatrix)},
+          _projectionScale{projectionMatrix[1][1]} {
+    }
+
+    AnimationLodLevel AnimationLod::select(const Vector3 &origin) const {
+        const Vector3 center = origin + Vector3::yAxis(BoundingCenterHeight);
+        if (!Math::Intersection::sphereFrustum(center, BoundingRadius, _frustum)) {
+            return AnimationLodLevel::Frozen;
+        }
+
+        /* The camera looks down -Z */
+        const Float distance = -_cameraMatrix.transformPoint(center).z();
+        if (distance > MaxDistance) return AnimationLodLevel::Frozen;
+        /* Close enough that the camera is inside the sphere */
+        if (distance <= BoundingRadius) return AnimationLodLevel::Full;
+
+        /* NDC spans 2 units over the viewport height */
+        const Float screenSize = BoundingRadius * _projectionScale / distance;
+        if (screenSize >= HalfRateScreenSize) return AnimationLodLevel::Full;
+        if (screenSize >= QuarterRateScreenSize) return AnimationLodLevel::Half;
+        return AnimationLodLevel::Quarter;
+    }
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <Magnum/Math/Frustum.h>
+#include <Magnum/Math/Matrix4.h>
+
+#include "MagnumGameCommon.h"
+
+namespace MagnumGame {
+
+    enum class AnimationLodLevel : UnsignedByte {
+        /* Updated every frame */
+        Full,
+        /* Updated every 2nd frame */
+        Half,
+        /* Updated every 4th frame, bones deeper than
+           AnimationClip::ReducedBoneDepth left alone */
+        Quarter,
+        /* Off screen or too far away, not updated at all */
+        Frozen,
+    };
+
+    constexpr std::size_t AnimationLodLevelCount = 4;
+
+    /**
+     * @brief Picks how much animation work a character gets from the camera
+     *
+     * Built once a frame from the camera, then asked for the level of every
+     * character by the bounding sphere around its origin. The thresholds are
+     * the fraction of the viewport height that sphere covers. Holds no GL
+     * state.
+     */
+    class AnimationLod {
+    public:
+        inline static Float HalfRateScreenSize = 0.15f;
+        inline static Float QuarterRateScreenSize = 0.06f;
+        inline static Float MaxDistance = 80.0f;
+        /* Bounding sphere of a character, relative to its origin at the feet */
+        inline static Float BoundingCenterHeight = 0.5f;
+        inline static Float BoundingRadius = 0.75f;
+
+        static UnsignedInt getUpdateInterval(AnimationLodLevel level) {
+            constexpr UnsignedInt intervals[]{1, 2, 4, 0};
+            return intervals[std::size_t(level)];
+        }
+
+        static bool usesReducedBones(AnimationLodLevel level) { return level == AnimationLodLevel::Quarter; }
+
+        static const char* getName(AnimationLodLevel level) {
+            constexpr const char* names[]{"Full", "Half", "Quarter", "Frozen"};
+            return names[std::size_t(level)];
+        }
+
+        explicit AnimationLod(const Matrix4& cameraMatrix, const Matrix4& projectionMatrix);
+
+        /* @p origin is the character's origin in world space */
+        AnimationLodLevel select(const Vector3& origin) const;
+
+    private:
+        Matrix4 _cameraMatrix;
+        Frustum _frustum;
+        /* Half of the viewport height per unit of size at a distance of 1 */
+        Float _projectionScale;
+    };
+}
@@ -0,0 +1,58 @@
+#include "AnimationState.h"
+
+#include <cmath>
+
+namespace MagnumGame {
+
+    Skin::Skin(const SkeletonAsset::Skin &skinAsset)
+        : _boneMatrices{DirectInit, skinAsset.jointBones.size(), Math::IdentityInit} {
+    }
+
+    AnimationState::AnimationState(const SkeletonAsset &skeleton)
+        : _skeleton{skeleton}, _pose{skeleton}, _skins{NoInit, skeleton.getSkins().size()} {
+        auto& skins = skeleton.getSkins();
+        for (std::size_t skinIndex = 0; skinIndex < skins.size(); skinIndex++) {
+            new (&_skins[skinIndex]) Skin{skins[skinIndex]};
+        }
+    }
+
+    void AnimationState::play(const AnimationClip &clip, bool restart) {
+        if (!restart && &clip == _clip) return;
+
+        /* The new clip may not animate every bone the old one did */
+        _pose.resetToDefault();
+        _clip = &clip;
+        _time = 0.0f;
+    }
+
+    void AnimationState::advance(Float seconds) {
+        _time += seconds * _speed;
+        /* Keeps the float precision from running out in long sessions */
+        if (_clip && _clip->getDuration().size() > 0.0f) {
+            _time = std::fmod(_time, _clip->getDuration().size());
+            if (_time < 0.0f) _time += _clip->getDuration().size();
+        }
+    }
+
+    void AnimationState::update(bool reduced) {
+        updateAt(_time, reduced);
+    }
+
+    void AnimationState::updateAt(Float time, bool reduced) {
+        if (_clip) _clip->sampleLooped(time, _pose, reduced);
+        _pose.computeModelMatrices();
+        auto& skins = _skeleton.getSkins();
+        for (std::size_t skinIndex = 0; skinIndex < _skins.size(); skinIndex++) {
+            _pose.writeJointMatrices(skins[skinIndex], _skins[skinIndex].boneMatrices());
+        }
+    }
+
+    std::size_t AnimationState::getByteSize() const {
+        std::size_t size = sizeof(AnimationState);
+        size += _skeleton.getBoneCount() * (2 * sizeof(Vector3) + sizeof(Quaternion) + sizeof(Matrix4));
+        for (auto& skin : _skins) {
+            size += sizeof(Skin) + skin.boneMatrices().size() * sizeof(Matrix4);
+        }
+        return size;
+    }
+}
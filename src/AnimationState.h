@@ -0,0 +1,96 @@
+#pragma once
+
+#include <Corrade/Containers/Array.h>
+#include <Magnum/Math/Matrix4.h>
+
+#include "MagnumGameCommon.h"
+#include "AnimationClip.h"
+#include "SkeletonAsset.h"
+
+namespace MagnumGame {
+
+    class Skin {
+    public:
+
+        explicit Skin(const SkeletonAsset::Skin& skinAsset);
+
+        Skin(const Skin &skin) = delete;
+        Skin &operator=(const Skin &skin) = delete;
+
+        Containers::Array<Matrix4>& boneMatrices() { return _boneMatrices; }
+        const Containers::Array<Matrix4>& boneMatrices() const { return _boneMatrices; }
+
+        /* Where the renderer keeps a copy of the bone matrices for the GPU,
+           the skin's own range unless it shows a pose from the PoseCache */
+        UnsignedInt getJointOffset() const { return _jointOffset; }
+        void setJointOffset(UnsignedInt offset) { _jointOffset = _ownJointOffset = offset; }
+
+        /* Shows the matrices at @p offset until the next call or
+           useOwnJointOffset() */
+        void shareJointOffset(UnsignedInt offset) { _jointOffset = offset; }
+        void useOwnJointOffset() { _jointOffset = _ownJointOffset; }
+
+    private:
+        Containers::Array<Matrix4> _boneMatrices{};
+        UnsignedInt _jointOffset{};
+        UnsignedInt _ownJointOffset{};
+
+    };
+
+    /**
+     * @brief Per-character animation state
+     *
+     * Everything a character needs on top of the shared SkeletonAsset and
+     * AnimationClip data: the clip being played, its time and the pose and
+     * joint matrices it produces. Holds no GL state, so a crowd of them can
+     * be benchmarked in the headless simulation.
+     */
+    class AnimationState {
+    public:
+        /* States updated by one job of GameState and the crowd benchmark,
+           fewer means finer load balancing but more overhead per job */
+        inline static Int UpdatesPerJob = 8;
+
+        explicit AnimationState(const SkeletonAsset& skeleton);
+
+        DISALLOW_COPY(AnimationState)
+
+        /* Starts @p clip from the beginning unless it's already playing and
+           @p restart is false */
+        void play(const AnimationClip& clip, bool restart);
+
+        const AnimationClip* getClip() const { return _clip; }
+
+        Float getTime() const { return _time; }
+        void setTime(Float time) { _time = time; }
+
+        Float getSpeed() const { return _speed; }
+        void setSpeed(Float speed) { _speed = speed; }
+
+        /* Moves the clip time on, wrapped to the clip length */
+        void advance(Float seconds);
+
+        /* Samples the clip and writes the joint matrices of every skin, only
+           the bones up to AnimationClip::ReducedBoneDepth if @p reduced */
+        void update(bool reduced = false);
+
+        /* Same, but samples the clip at @p time instead of the current time */
+        void updateAt(Float time, bool reduced = false);
+
+        SkeletonPose& getPose() { return _pose; }
+
+        Skin& getSkin(std::size_t skinIndex) { return _skins[skinIndex]; }
+        std::size_t getSkinCount() const { return _skins.size(); }
+
+        /* Heap and inline memory of this instance, the shared assets excluded */
+        std::size_t getByteSize() const;
+
+    private:
+        const SkeletonAsset& _skeleton;
+        const AnimationClip* _clip{};
+        Float _time{};
+        Float _speed{1.0f};
+        SkeletonPose _pose;
+        Containers::Array<Skin> _skins;
+    };
+}
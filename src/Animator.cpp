@@ -10,75 +10,71 @@
 #include <Corrade/Containers/GrowableArray.h>
 #include <Magnum/Trade/AnimationData.h>
 #include <Corrade/Containers/StructuredBindings.h>
-#include <Magnum/Math/CubicHermite.h>
 #include <Magnum/MeshTools/Compile.h>
-#include <Magnum/SceneGraph/Camera.h>
 #include <Magnum/Trade/MeshData.h>
 
 #include "GameAssets.h"
 #include "TexturedDrawable.h"
 #include "GameShader.h"
+#include "SkinnedMesh.h"
 
 namespace MagnumGame {
 
     Animator::Animator(Object3D &rootObject, const AnimatorAsset &asset, GameShader &meshShader,
-                       SceneGraph::DrawableGroup3D *animDrawables, SceneGraph::DrawableGroup3D *meshDrawables)
+                       SceneGraph::DrawableGroup3D *animDrawables, SceneGraph::DrawableGroup3D *meshDrawables,
+                       bool skinOnce, const BakedAnimation* baked)
         : SceneGraph::Drawable3D(rootObject, animDrawables)
-    , _fakeBoneCamera{_boneScene}
-    , _skins{NoInit, asset._skins.size()}
+    , _asset{asset}
+    , _state{asset._skeleton}
+    , _baked{baked}
     {
-        std::map<int, BoneObject *> boneMap;
+        static UnsignedInt instanceCount = 0;
+        _lodPhase = instanceCount++;
 
-        std::function<void(BoneObject &, const AnimatorAsset::Bone &, int)> instantiateBone =
-            [&](BoneObject &parentBone, const AnimatorAsset::Bone &boneAsset, int depth) {
-
-            boneMap[boneAsset.boneId] = &parentBone;
-            parentBone.setTranslation(boneAsset.defaultTranslation);
-            parentBone.setRotation(boneAsset.defaultRotation);
-            parentBone.setScaling(boneAsset.defaultScale);
-            Debug{} << std::string(depth, '\t') << "Bone" << boneAsset.name;
-
-            for (auto &childBoneAsset: boneAsset.children) {
-                instantiateBone(parentBone.addChild<BoneObject>(), childBoneAsset, depth + 1);
-            }
-        };
-
-        instantiateBone(getRootBone(), asset._rootBone, 0);
-
-        std::map<const AnimatorAsset::SkinAsset*, Skin*> skinMap;
-        for (auto skinIndex = 0U; skinIndex < asset._skins.size(); ++skinIndex) {
-            auto& skinAsset = asset._skins[skinIndex];
-            auto& skin = *new (&_skins[skinIndex]) Skin{skinAsset};
-            Debug{} << "Skin setup asset=" << &skinAsset << "skin" << &skin << "matrices" << &skin.boneMatrices() << "data @" << skin.boneMatrices().data() << "size" << skin.boneMatrices().size();
-            skinMap[&skinAsset] = &skin;
-
-            for (auto jointIndex = 0U; jointIndex < skinAsset._jointBoneIds.size(); jointIndex++) {
-                auto joint = skinAsset._jointBoneIds[jointIndex];
-                boneMap[joint]->addFeature<JointDrawable>(skinAsset._inverseBindMatrices[jointIndex], skin.boneMatrices()[jointIndex], _jointDrawables);
+        if (_baked) {
+            _bakedPlayback = Containers::Array<BakedPlayback>{ValueInit, _state.getSkinCount()};
+            for (std::size_t skin = 0; skin < _state.getSkinCount(); skin++) {
+                _bakedPlayback[skin].jointCount = UnsignedInt(_state.getSkin(skin).boneMatrices().size());
             }
         }
 
-        std::map<int, Object3D *> objectMap;
         std::function<void(Object3D &, const AnimatorAsset::SkinMeshNode&)> processMeshes = [&](Object3D &parent, const AnimatorAsset::SkinMeshNode& parentAsset) {
 
             parent.setTransformation(parentAsset.transform);
 
             if (parentAsset.skinMesh.mesh != nullptr && parentAsset.skinMesh.material != nullptr) {
-                auto& drawable = parent.addFeature<TexturedDrawable>(parentAsset.skinMesh.material->texture, meshShader, *parentAsset.skinMesh.mesh, *meshDrawables);
-                arrayAppend(_meshDrawables, InPlaceInit, drawable);
-
-                if (parentAsset.skinMesh.skin != nullptr) {
-                    auto skinBone = skinMap.find(parentAsset.skinMesh.skin);
-                    if (skinBone != skinMap.end()) {
-                        Debug{} << "Skin insta asset=" << parentAsset.skinMesh.skin << "skin" << skinBone->second << "matrices" << &skinBone->second->boneMatrices() << "data @"<< skinBone->second->boneMatrices().data() << "size" << skinBone->second->boneMatrices().size();
-                        drawable.setSkin(*skinBone->second,
+                auto skinId = parentAsset.skinMesh.skinId;
+                const bool hasSkin = skinId >= 0 && std::size_t(skinId) < _state.getSkinCount();
+
+                if (_baked && hasSkin) {
+                    auto& drawable = parent.addFeature<TexturedDrawable>(parentAsset.skinMesh.material->texture, meshShader, *parentAsset.skinMesh.mesh, *meshDrawables);
+                    arrayAppend(_meshDrawables, InPlaceInit, drawable);
+                    drawable.setBakedSkin(_bakedPlayback[skinId], parentAsset.skinMesh.perVertexJointCounts);
+                }
+                /* Drawn from the skinned copy like any static mesh */
+                else if (skinOnce && hasSkin && parentAsset.skinMesh.skinningSource) {
+                    auto& skinnedMesh = *arrayAppend(_skinnedMeshes, InPlaceInit, Containers::Pointer<SkinnedMesh>{InPlaceInit,
+                        *parentAsset.skinMesh.skinningSource, _state.getSkin(skinId), parentAsset.skinMesh.perVertexJointCounts});
+                    auto& drawable = parent.addFeature<TexturedDrawable>(parentAsset.skinMesh.material->texture, meshShader, skinnedMesh.getMesh(), *meshDrawables);
+                    arrayAppend(_meshDrawables, InPlaceInit, drawable);
+                } else {
+                    auto& drawable = parent.addFeature<TexturedDrawable>(parentAsset.skinMesh.material->texture, meshShader, *parentAsset.skinMesh.mesh, *meshDrawables);
+                    arrayAppend(_meshDrawables, InPlaceInit, drawable);
+
+                    if (hasSkin) {
+                        drawable.setSkin(_state.getSkin(skinId),
                             parentAsset.skinMesh.perVertexJointCounts,
                             parentAsset.skinMesh.perVertexJointCountsSecondary);
                     }
-                    else {
-                        Error{} << "No skin bone found for" << parentAsset.skinMesh.skin;
+                    else if (skinId >= 0) {
+                        Error{} << "No skin found for" << skinId;
                     }
                 }
+
+                /* Poses reach outside of the bind pose */
+                auto bounds = parentAsset.skinMesh.bounds;
+                if (hasSkin) bounds = bounds.padded(Vector3{bounds.size().max() * SkinnedBoundsPadding});
+                _meshDrawables.back()->setBounds(bounds);
             }
 
             for (auto& child : parentAsset.children) {
@@ -87,162 +83,104 @@ namespace MagnumGame {
         };
 
         processMeshes(rootObject, asset._rootSkinMeshNode);
-
-        for (auto& [animationName, animationData] : asset._animations) {
-            _animationPlayers.emplace(std::piecewise_construct,
-                std::forward_as_tuple(animationName),
-                std::forward_as_tuple(animationName, asset, boneMap));
-        }
     }
 
-
-    Animator::Animation::Animation(const Containers::StringView& animationName, const AnimatorAsset &asset, std::map<int, BoneObject *>& boneMap) {
-        auto& animationData = asset._animations.at(animationName);
-
-        // Debug{} << "Instancing anim" << animationName;
-        for (UnsignedInt trackIndex = 0; trackIndex != animationData.trackCount(); ++trackIndex) {
-
-            auto animatedObjectId = animationData.trackTarget(trackIndex);
-            auto targetBone = asset._bonesById.find(animatedObjectId);
-
-            if (targetBone != asset._bonesById.end()) {
-                addAnimationTrack(animationData, trackIndex, targetBone->second, boneMap);
-            }
-            else {
-                Warning warning{};
-                warning << "Animation" << animationName << "Failed to find target bone" << animatedObjectId
-                                  << "Track" << animationName << "track" << trackIndex
-                                  << "target" << animationData.trackTarget(trackIndex)
-                                  << "type" << animationData.trackType(trackIndex)
-                                  << "(name" << animationData.trackTargetName(trackIndex) << ")"
-                                  << "result" << animationData.trackResultType(trackIndex);
-
-                warning << Warning::newline << "But we have:";
-                for (auto& [boneId, bone] : asset._bonesById) {
-                    warning << Warning::newline << "Bone " << boneId << "->" << bone.boneId << bone.name;
+    AnimationLodLevel Animator::prepareUpdate(Float frameDuration, const AnimationLod &lod, UnsignedLong frameIndex) {
+        /* Time always moves on, so skipped frames don't slow the clip down */
+        _state.advance(frameDuration);
+
+        auto level = lod.select(object().absoluteTransformationMatrix().translation());
+
+        /* The GPU does the rest, so every visible character plays at the
+           full rate */
+        if (_baked) {
+            _updated = false;
+            auto clip = _state.getClip();
+            if (_bakedClip && clip && level != AnimationLodLevel::Frozen) {
+                const Float length = clip->getDuration().size();
+                const Float frame = length > 0.0f ? _state.getTime() / length * Float(_bakedClip->frameCount) : 0.0f;
+                for (auto& playback : _bakedPlayback) {
+                    playback.frame = Math::clamp(frame, 0.0f, Float(_bakedClip->frameCount) - 0.001f);
                 }
             }
+            return level;
         }
 
-        player.setDuration(animationData.duration());
-        player.setPlayCount(0);
+        auto interval = AnimationLod::getUpdateInterval(level);
+        _updated = interval && (frameIndex + _lodPhase) % interval == 0;
+        _reducedUpdate = AnimationLod::usesReducedBones(level);
+        return level;
     }
 
-    void Animator::Animation::addAnimationTrack(const Trade::AnimationData &animation, UnsignedInt trackIndex, const AnimatorAsset::Bone& bone, std::map<int, BoneObject*>& boneMap) {
-
-        auto animatedObjectId = animation.trackTarget(trackIndex);
-        auto targetObject = boneMap.find(animatedObjectId);
-
-        if (targetObject == boneMap.end()) {
-            Warning{} << "Can't find bone for animation track" << trackIndex << animatedObjectId;
-            return;
-        }
-
-        auto &animatedObject = *targetObject->second;
+    void Animator::updatePose() {
+        /* A cache entry is shown at every LOD, so it gets the whole skeleton
+           no matter how far away the character filling it is. A miss happens
+           only once per step, which keeps that cheap */
+        if (_cachedPoseTime >= 0.0f) _state.updateAt(_cachedPoseTime);
+        else _state.update(_reducedUpdate);
+        _needsSkinning = true;
+    }
 
-        switch (animation.trackTargetName(trackIndex)) {
-            case Trade::AnimationTrackTarget::Translation3D: {
-                const auto callback = [](Float, const Vector3 &translation, auto &object) {
-                    object.setTranslation(translation);
-                };
-                if (animation.trackType(trackIndex) == Trade::AnimationTrackType::CubicHermite3D) {
-                    player.addWithCallback(animation.track<CubicHermite3D>(trackIndex),
-                                           callback, animatedObject);
-                } else {
-                    CORRADE_INTERNAL_ASSERT(
-                        animation.trackType(trackIndex) == Trade::AnimationTrackType::Vector3);
-                    player.addWithCallback(animation.track<Vector3>(trackIndex),
-                                           callback, animatedObject);
-                }
-                arrayAppend(resetPositions, InPlaceInit, &animatedObject, bone.defaultTranslation);
-            }
-            break;
-            case Trade::AnimationTrackTarget::Rotation3D: {
-                const auto callback = [](Float, const Quaternion &rotation, auto &object) {
-                    object.setRotation(rotation);
-                };
-                if (animation.trackType(trackIndex) == Trade::AnimationTrackType::CubicHermiteQuaternion) {
-                    player.addWithCallback(animation.track<CubicHermiteQuaternion>(trackIndex),
-                                           callback, animatedObject);
-                } else {
-                    CORRADE_INTERNAL_ASSERT(
-                        animation.trackType(trackIndex) == Trade::AnimationTrackType::Quaternion);
-                    player.addWithCallback(animation.track<Quaternion>(trackIndex),
-                                           callback, animatedObject);
-                }
-                arrayAppend(resetRotations, InPlaceInit, &animatedObject, bone.defaultRotation);
-            }
-            break;
-            case Trade::AnimationTrackTarget::Scaling3D: {
-                const auto callback = [](Float, const Vector3 &scaling, auto &object) {
-                    object.setScaling(scaling);
-                };
-                if (animation.trackType(trackIndex) == Trade::AnimationTrackType::CubicHermite3D) {
-                    player.addWithCallback(animation.track<CubicHermite3D>(trackIndex),
-                                           callback, animatedObject);
-                } else {
-                    CORRADE_INTERNAL_ASSERT(
-                        animation.trackType(trackIndex) == Trade::AnimationTrackType::Vector3);
-                    player.addWithCallback(animation.track<Vector3>(trackIndex),
-                                           callback, animatedObject);
-                }
-                arrayAppend(resetScales, InPlaceInit, &animatedObject, bone.defaultScale);
-            }
-            break;
-            default: CORRADE_INTERNAL_ASSERT_UNREACHABLE();
-                break;
+    void Animator::showCachedPose(Containers::ArrayView<const UnsignedInt> jointOffsets) {
+        /* Cached poses never change once filled, so only a different step
+           needs skinning again */
+        for (std::size_t i = 0; i < jointOffsets.size(); i++) {
+            auto& skin = _state.getSkin(i);
+            if (skin.getJointOffset() == jointOffsets[i]) continue;
+            skin.shareJointOffset(jointOffsets[i]);
+            _needsSkinning = true;
         }
+        _updated = false;
     }
 
-    void Animator::Animation::stop() {
-        player.stop();
-        for (auto& [bone, position] : resetPositions) {
-            bone->setTranslation(position);
-        }
-        for (auto& [bone, rotation] : resetRotations) {
-            bone->setRotation(rotation);
-        }
-        for (auto& [bone,scale] : resetScales) {
-            bone->setScaling(scale);
+    void Animator::fillCachedPose(Float time, Containers::ArrayView<const UnsignedInt> jointOffsets) {
+        for (std::size_t skin = 0; skin < jointOffsets.size(); skin++) {
+            _state.getSkin(skin).shareJointOffset(jointOffsets[skin]);
         }
+        _cachedPoseTime = time;
     }
 
-    void Animator::Animation::play() {
-        player.play(std::chrono::system_clock::now().time_since_epoch());
+    void Animator::useOwnPose() {
+        for (std::size_t skin = 0; skin < _state.getSkinCount(); skin++) {
+            _state.getSkin(skin).useOwnJointOffset();
+        }
+        _cachedPoseTime = -1.0f;
     }
 
-    Skin &Animator::getSkin(size_t skinIndex) {
-        return _skins[skinIndex];
-    }
+    UnsignedInt Animator::skinMeshes(SkinningShader &shader, GL::TransformFeedback &feedback) {
+        if (!_needsSkinning) return 0;
+        _needsSkinning = false;
 
-    Skin::Skin(const AnimatorAsset::SkinAsset &skinAsset)
-        : _boneMatrices{DirectInit, skinAsset._inverseBindMatrices.size(), Math::IdentityInit} {
+        UnsignedInt vertexCount = 0;
+        for (auto& skinnedMesh : _skinnedMeshes) {
+            skinnedMesh->skin(shader, feedback);
+            vertexCount += skinnedMesh->getVertexCount();
+        }
+        return vertexCount;
     }
 
     void Animator::draw(const Matrix4 &, SceneGraph::Camera3D &) {
-        if (_currentAnimation) {
-            _currentAnimation->player.advance(std::chrono::system_clock::now().time_since_epoch());
-        }
-        _fakeBoneCamera.draw(_jointDrawables);
+        /* Nothing, GameState::update() drives animators through
+           prepareUpdate() and updatePose() with their LOD, reduced bones,
+           pose cache and baked clips */
     }
 
     void Animator::play(const Containers::StringView &animationName, bool restart) {
-        auto animIt = _animationPlayers.find(animationName);
-        if (animIt == _animationPlayers.end()) {
+        auto clip = _asset._clips.find(animationName);
+        if (clip == _asset._clips.end()) {
             Warning{} << "Can't find animation" << animationName;
             return;
         }
 
-        if (!restart && &animIt->second == _currentAnimation) {
-            return;
-        }
+        _state.play(clip->second, restart);
 
-        if (_currentAnimation) {
-            _currentAnimation->stop();
+        if (_baked) {
+            _bakedClip = _baked->getClip(animationName);
+            if (!_bakedClip) return;
+            for (std::size_t skin = 0; skin < _bakedPlayback.size(); skin++) {
+                _bakedPlayback[skin].clipOffset = _bakedClip->skinOffsets[skin];
+                _bakedPlayback[skin].frameCount = _bakedClip->frameCount;
+            }
         }
-        _currentAnimation = &_animationPlayers.at(animationName);
-        _currentAnimation = &animIt->second;
-        assert(_currentAnimation == &animIt->second);
-        _currentAnimation->play();
     }
 } // MagnumGame
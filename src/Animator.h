@@ -1,10 +1,7 @@
 #pragma once
 
-#include <Magnum/Animation/Player.h>
 #include <Magnum/SceneGraph/AbstractFeature.h>
 #include <Magnum/SceneGraph/AbstractObject.h>
-#include <Magnum/SceneGraph/Scene.h>
-#include <Magnum/SceneGraph/TranslationRotationScalingTransformation3D.h>
 #include <Magnum/Math/Matrix4.h>
 #include <Corrade/Tags.h>
 #include <Magnum/SceneGraph/Drawable.h>
@@ -12,8 +9,8 @@
 #include <Corrade/Containers/Array.h>
 #include <Corrade/Containers/ArrayView.h>
 #include <Corrade/Containers/StringStlHash.h>
+#include <Corrade/Containers/Pointer.h>
 #include <Corrade/Containers/Reference.h>
-#include <Magnum/SceneGraph/Camera.h>
 #include <Magnum/Trade/AnimationData.h>
 #include <Magnum/Trade/MaterialData.h>
 
@@ -21,105 +18,108 @@
 #include "MagnumGameApp.h"
 #include "MagnumGameCommon.h"
 #include "AnimatorAsset.h"
+#include "IAnimatable.h"
+#include "AnimationLod.h"
+#include "AnimationState.h"
+#include "BakedAnimation.h"
 
 namespace MagnumGame {
     class TexturedDrawable;
     class GameShader;
+    class SkinnedMesh;
+    class SkinningShader;
     using namespace Magnum;
 
-    class Skin;
 
-
-    class Animator : public SceneGraph::Drawable3D {
+    class Animator : public SceneGraph::Drawable3D, public IAnimatable {
     public:
-        typedef Animation::Player<std::chrono::nanoseconds, Float> AnimationPlayer;
+        /* Added around the bind pose bounds of skinned meshes on every
+           side, as a fraction of their largest size */
+        inline static Float SkinnedBoundsPadding = 0.5f;
+
+        /* With @p skinOnce, meshes that allow it are skinned into a
+           SkinnedMesh by skinMeshes() and drawn from there. With @p baked
+           the skinned meshes play clips from it instead, @p meshShader has
+           to be a bakedAnimation one then, and the pose is never updated */
+        explicit Animator(Object3D &rootObject, const AnimatorAsset &asset, GameShader &meshShader,
+                          SceneGraph::DrawableGroup3D *animDrawables, SceneGraph::DrawableGroup3D *meshDrawables,
+                          bool skinOnce = false, const BakedAnimation* baked = nullptr);
 
-        typedef SceneGraph::Object<SceneGraph::TranslationRotationScalingTransformation3D> BoneObject;
-        typedef SceneGraph::Scene<SceneGraph::TranslationRotationScalingTransformation3D> BoneScene;
+        bool isBaked() const { return _baked != nullptr; }
 
-        explicit Animator(Object3D &rootObject, const AnimatorAsset &asset, GameShader &meshShader,
-                          SceneGraph::DrawableGroup3D *animDrawables, SceneGraph::DrawableGroup3D *meshDrawables);
+        Skin& getSkin(size_t skinIndex) { return _state.getSkin(skinIndex); }
 
-        Skin& getSkin(size_t skinIndex);
+        SkeletonPose& getPose() { return _state.getPose(); }
 
-        BoneScene &getRootBone() { return _boneScene; }
+        AnimationState& getState() { return _state; }
 
-        void draw(const Matrix4 &transformationMatrix, SceneGraph::Camera3D &camera) override;
+        /* Advances the clip and decides from the level @p lod picks whether
+           updatePose() has work this frame, called once a frame for every
+           animator on the main thread */
+        AnimationLodLevel prepareUpdate(Float frameDuration, const AnimationLod& lod, UnsignedLong frameIndex);
 
-        void play(const Containers::StringView& animationName, bool restart);
+        /* Whether the last prepareUpdate() asked for a pose update */
+        bool needsPoseUpdate() const { return _updated; }
 
-        Containers::Array<Containers::Reference<TexturedDrawable>>& meshDrawables() { return _meshDrawables; }
+        /* Samples the clip into the pose and the Skin joint matrices. Only
+           touches this animator's own state, so different animators can be
+           updated on different threads */
+        void updatePose();
 
-    private:
+        /* Crowd characters look their pose up in the PoseCache */
+        bool usesPoseCache() const { return _usesPoseCache; }
+        void setUsesPoseCache(bool usesPoseCache) { _usesPoseCache = usesPoseCache; }
+
+        /* Instead of the next updatePose(), shows the cached pose at
+           @p jointOffsets, one per skin */
+        void showCachedPose(Containers::ArrayView<const UnsignedInt> jointOffsets);
 
-        struct Animation {
-            AnimationPlayer player{};
-            Containers::Array<Containers::Pair<BoneObject*, Vector3>> resetPositions{};
-            Containers::Array<Containers::Pair<BoneObject*, Quaternion>> resetRotations{};
-            Containers::Array<Containers::Pair<BoneObject*, Vector3>> resetScales{};
+        /* Makes the next updatePose() sample the whole skeleton at @p time,
+           the time of a PoseCache step, with the joint matrices going to the
+           cache entry at @p jointOffsets */
+        void fillCachedPose(Float time, Containers::ArrayView<const UnsignedInt> jointOffsets);
 
-            explicit Animation(const Containers::StringView& animationName, const AnimatorAsset &asset, std::map<int, BoneObject *>& boneMap);
+        /* Makes the next updatePose() sample its own pose again */
+        void useOwnPose();
 
-            void addAnimationTrack(const Trade::AnimationData &animation, UnsignedInt trackIndex, const AnimatorAsset::Bone & bone, std::map<int, BoneObject*>& boneMap);
+        /* Skins the SkinnedMesh instances if the pose changed since they
+           were last skinned, returns the vertices skinned */
+        UnsignedInt skinMeshes(SkinningShader& shader, GL::TransformFeedback& feedback);
 
-            void stop();
+        void draw(const Matrix4 &transformationMatrix, SceneGraph::Camera3D &camera) override;
+
+        void play(const Containers::StringView& animationName, bool restart) override;
 
-            void play();
+        Containers::Array<Containers::Reference<TexturedDrawable>>& meshDrawables() { return _meshDrawables; }
 
-            DISALLOW_COPY(Animation);
-        };
+    private:
 
         //Animation state data
-        BoneScene _boneScene{};
-        SceneGraph::Camera3D _fakeBoneCamera;
-        SceneGraph::DrawableGroup3D _jointDrawables{};
-        Containers::Array<Skin> _skins;
+        const AnimatorAsset& _asset;
+        AnimationState _state;
+        /* Spreads characters on the same level over the frames they skip */
+        UnsignedInt _lodPhase;
+        bool _updated{};
+        bool _reducedUpdate{};
+        bool _usesPoseCache{};
+        /* Set by fillCachedPose() for the next updatePose() */
+        Float _cachedPoseTime{-1.0f};
         Containers::Array<Containers::Reference<TexturedDrawable>> _meshDrawables{};
-
-        Animation* _currentAnimation{};
-        Containers::String _defaultAnimationName;
-
-        std::unordered_map<Containers::String, Animation> _animationPlayers{};
+        const BakedAnimation* _baked;
+        const BakedAnimation::Clip* _bakedClip{};
+        /* One per skin, read by the drawables */
+        Containers::Array<BakedPlayback> _bakedPlayback{};
+        Containers::Array<Containers::Pointer<SkinnedMesh>> _skinnedMeshes{};
+        /* Whether the pose changed since skinMeshes() last ran */
+        bool _needsSkinning{true};
     };
 
     struct SkinMeshDrawable {
-        Containers::Array<Matrix4>* boneMatrices{};
+        const Skin* skin{};
         UnsignedInt perVertexJointCount{};
         UnsignedInt secondaryPerVertexJointCount{};
+        /* Set instead of skin for characters playing a BakedAnimation */
+        const BakedPlayback* baked{};
     };
 
-    class Skin {
-    public:
-
-        explicit Skin(const AnimatorAsset::SkinAsset& skinAsset);
-
-        Skin(const Skin &skin) = delete;
-        Skin &operator=(const Skin &skin) = delete;
-
-        Containers::Array<Matrix4>& boneMatrices() { return _boneMatrices; }
-
-    private:
-        Containers::Array<Matrix4> _boneMatrices{};
-
-    };
-
-
-    class JointDrawable : public SceneGraph::Drawable3D {
-    public:
-        explicit JointDrawable(Animator::BoneObject &object, const Matrix4 &inverseBindMatrix, Matrix4 &jointMatrix,
-                               SceneGraph::DrawableGroup3D &group)
-            : SceneGraph::Drawable3D{object, &group},
-              _inverseBindMatrix{inverseBindMatrix},
-              /* GCC 4.8 can't handle {} here */
-              _jointMatrix(jointMatrix) {
-        }
-
-    private:
-        void draw(const Matrix4 &transformationMatrix, SceneGraph::Camera3D &) override {
-            _jointMatrix = transformationMatrix * _inverseBindMatrix;
-        }
-
-        Matrix4 _inverseBindMatrix;
-        Matrix4 &_jointMatrix;
-    };
 } // MagnumGame
@@ -13,56 +13,31 @@
 #include <Magnum/Trade/SkinData.h>
 #include <Magnum/Trade/MeshData.h>
 #include <Magnum/MeshTools/Compile.h>
+#include <Magnum/Math/FunctionsBatch.h>
 
 #include "GameAssets.h"
 
 namespace MagnumGame {
-    AnimatorAsset::SkinAsset::SkinAsset(const Containers::ArrayView<const UnsignedInt> &joints,
-                                        const Containers::ArrayView<const Matrix4> &inverseBindMatrices)
-        : _jointBoneIds(InPlaceInit, joints),
-          _inverseBindMatrices(InPlaceInit, inverseBindMatrices) {
-    }
-
     AnimatorAsset::AnimatorAsset(Trade::AbstractImporter &importer)
-        : _meshes(DefaultInit, importer.meshCount())
+        : _skinningSources{importer.meshCount()}
+          , _meshes(DefaultInit, importer.meshCount())
           , _textures(GameAssets::loadTextures(importer))
           , _materials(GameAssets::loadMaterials(importer, _textures))
-          , _skins{NoInit, importer.skin3DCount()} {
+          , _skeleton{importer} {
         auto sceneId = importer.defaultScene();
         Debug{} << "Scene" << sceneId << ":" << importer.sceneName(sceneId);
         auto sceneData = importer.scene(sceneId);
 
         std::set<int> meshTree{};
-        std::function<bool(int, Bone &, int)> processBones = [&](int parentId, Bone &parentBone, int depth) {
-            assert(_bonesById.find(parentId) == _bonesById.end());
-            _bonesById.insert({parentId, parentBone});
-            assert(_bonesById.find(parentId) != _bonesById.end());
-            assert(&_bonesById.find(parentId)->second == &parentBone);
-
-            parentBone.boneId = parentId;
-
+        std::function<bool(int, int)> processBones = [&](int parentId, int depth) {
             bool usedByMesh = parentId >= 0 && !sceneData->meshesMaterialsFor(parentId).isEmpty();
 
             Debug{} << std::string(depth, '\t') << "Bone" << parentId
                     << (parentId == -1 ? "ROOT" : importer.objectName(parentId))
                     << (usedByMesh ? "HAS MESH" : "");
 
-            std::vector<Bone> newBones;
-
-            auto childIds = sceneData->childrenFor(parentId);
-            parentBone.children = Containers::Array<Bone>{NoInit, childIds.size()};
-            for (size_t childIndex = 0; childIndex < childIds.size(); ++childIndex) {
-                auto childId = childIds[childIndex];
-                auto &childBone = *new(&parentBone.children[childIndex]) Bone(importer.objectName(childId));
-
-
-                if (auto transform = sceneData->transformation3DFor(childId)) {
-                    childBone.defaultTranslation = transform->translation();
-                    childBone.defaultRotation = Quaternion::fromMatrix(transform->rotation());
-                    childBone.defaultScale = transform->scaling();
-                }
-
-                if (processBones(childId, childBone, depth + 1)) {
+            for (auto childId : sceneData->childrenFor(parentId)) {
+                if (processBones(childId, depth + 1)) {
                     usedByMesh = true;
                 }
             }
@@ -74,21 +49,11 @@ namespace MagnumGame {
             return usedByMesh;
         };
 
-        processBones(-1, _rootBone, 0);
-
-        for (auto skinId = 0U; skinId < importer.skin3DCount(); skinId++) {
-            Debug{} << "Skin" << skinId << importer.skin3DName(skinId) << "Allocated";
-
-            auto skinData = importer.skin3D(skinId);
-            auto inverseBindMatrices = skinData->inverseBindMatrices();
-
-            auto jointIds = skinData->joints();
-            assert(jointIds.size() == inverseBindMatrices.size());
-            new(&_skins[skinId]) SkinAsset{jointIds, inverseBindMatrices};
-        }
+        processBones(-1, 0);
 
         Debug{} << "Meshes:" << importer.meshCount();
         Containers::Array<Containers::Pair<UnsignedInt, UnsignedInt> > perVertexJointCounts{importer.meshCount()};
+        Containers::Array<Range3D> meshBounds{importer.meshCount()};
         for (auto meshId = 0U; meshId < importer.meshCount(); meshId++) {
             auto meshName = importer.meshName(meshId);
             Debug{} << "\tMesh" << meshId << ":" << meshName;
@@ -99,12 +64,42 @@ namespace MagnumGame {
             //     Debug{} << "\tAttribute" << attrId << ":" << attrName << "format=" << meshData->attributeFormat(attrId) << " offset=" << meshData->attributeOffset(attrId) << " stride=" << meshData->attributeStride(attrId) << " arraySize=" << meshData->attributeArraySize(attrId) << " morphTargetId=" << meshData->attributeMorphTargetId(attrId);
             // }
 
+            auto textureCoordinates = meshData->findAttributeId(Trade::MeshAttribute::TextureCoordinates);
+            if (meshData->isIndexed() && textureCoordinates && meshData->hasAttribute(Trade::MeshAttribute::JointIds)
+                && MeshTools::compiledPerVertexJointCount(*meshData).second() == 0) {
+                /* The vertex and index buffers are shared by the mesh drawn
+                   as is, the points the skinning pass reads and the meshes
+                   drawing the skinned result */
+                auto& source = _skinningSources[meshId].emplace(SkinningSource{
+                    GL::Buffer{GL::Buffer::TargetHint::Array, meshData->vertexData()},
+                    GL::Buffer{GL::Buffer::TargetHint::ElementArray, meshData->indexData()},
+                    GL::Mesh{NoCreate},
+                    meshData->vertexCount(),
+                    meshData->indexType(),
+                    meshData->indexOffset(),
+                    meshData->indexCount(),
+                    meshData->attributeFormat(*textureCoordinates),
+                    meshData->attributeOffset(*textureCoordinates),
+                    meshData->attributeStride(*textureCoordinates)
+                });
+                _meshes[meshId] = MeshTools::compile(*meshData, source.indices, source.vertices);
+
+                const Trade::MeshData pointsData{MeshPrimitive::Points, {}, meshData->vertexData(),
+                                                 Trade::meshAttributeDataNonOwningArray(meshData->attributeData()),
+                                                 meshData->vertexCount()};
+                GL::Buffer noIndices{NoCreate};
+                source.points = MeshTools::compile(pointsData, noIndices, source.vertices);
+            } else {
+                _meshes[meshId] = MeshTools::compile(*meshData);
+            }
             [[maybe_unused]]
-            auto &mesh = _meshes[meshId] = MeshTools::compile(*meshData);
+            auto &mesh = _meshes[meshId];
 #ifndef MAGNUM_TARGET_WEBGL
             mesh.setLabel(meshName);
 #endif
             perVertexJointCounts[meshId] = MeshTools::compiledPerVertexJointCount(*meshData);
+            auto positions = meshData->positions3DAsArray();
+            if (!positions.isEmpty()) meshBounds[meshId] = Range3D{Math::minmax(positions)};
         }
 
         std::function<void(int, SkinMeshNode &, int)> processMeshes = [&](int parentId, SkinMeshNode &parentAsset, int depth) {
@@ -139,11 +134,13 @@ namespace MagnumGame {
 
                     auto meshPerVertexJointCounts = perVertexJointCounts[meshId];
                     child.skinMesh = {
-                        &_skins[skinId],
+                        skinId,
                         &_meshes[meshId],
                         &_materials[matId],
                         meshPerVertexJointCounts.first(),
-                        meshPerVertexJointCounts.second()
+                        meshPerVertexJointCounts.second(),
+                        _skinningSources[meshId] ? &*_skinningSources[meshId] : nullptr,
+                        meshBounds[meshId]
                     };
                 }
 
@@ -160,7 +157,14 @@ namespace MagnumGame {
                 auto animationName = importer.animationName(animationIndex);
                 debug << animationName;
                 auto animationData = importer.animation(animationIndex);
-                _animations.insert(std::pair{animationName, std::move(*animationData)});
+                if (!animationData) continue;
+                auto& clip = _clips.emplace(animationName, AnimationClip{*animationData, _skeleton}).first->second;
+                if (CompressClips) {
+                    auto result = clip.compress(ClipCompression);
+                    Debug{} << "Compressed" << animationName << result.originalByteSize << "->" << result.byteSize
+                            << "bytes," << result.getRatio() << "x, max error" << result.maxTranslationError << "/"
+                            << result.maxRotationError << "/" << result.maxScalingError;
+                }
             }
         }
     }
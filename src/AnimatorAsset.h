@@ -3,10 +3,17 @@
 #include <map>
 #include <Corrade/Containers/Array.h>
 #include <Corrade/Containers/Optional.h>
+#include <Magnum/Mesh.h>
+#include <Magnum/VertexFormat.h>
+#include <Magnum/GL/Buffer.h>
+#include <Magnum/GL/Mesh.h>
 #include <Magnum/GL/Texture.h>
 #include <Magnum/Math/Quaternion.h>
+#include <Magnum/Math/Range.h>
 #include <Magnum/Trade/AbstractImporter.h>
 #include "MagnumGameCommon.h"
+#include "AnimationClip.h"
+#include "SkeletonAsset.h"
 
 
 namespace MagnumGame {
@@ -18,56 +25,60 @@ namespace MagnumGame {
     };
 
     struct AnimatorAsset {
-
-        struct Bone {
-            int boneId;
-            Containers::String name;
-            Vector3 defaultTranslation{};
-            Quaternion defaultRotation{Math::IdentityInit};
-            Vector3 defaultScale{1,1,1};
-            Containers::Array<Bone> children{};
-
-            explicit Bone(const Containers::String &name)
-                : name(name) {
-            }
-            DISALLOW_COPY(Bone)
-        };
-
-        struct SkinAsset {
-            Containers::Array<UnsignedInt> _jointBoneIds;
-            Containers::Array<Matrix4> _inverseBindMatrices{};
-
-            explicit SkinAsset(const Containers::ArrayView<const UnsignedInt> &joints,
-                const Containers::ArrayView<const Matrix4>& inverseBindMatrices);
-            DISALLOW_COPY(SkinAsset)
+        /* Read when the asset is loaded */
+        inline static bool CompressClips = false;
+        inline static AnimationCompression ClipCompression{};
+
+        /* Buffers and layout of a skinned mesh, so a SkinnedMesh can skin
+           it into a buffer of its own and draw that with the same texture
+           coordinates and indices */
+        struct SkinningSource {
+            GL::Buffer vertices;
+            GL::Buffer indices;
+            /* Every vertex once, the input of the SkinningShader */
+            GL::Mesh points;
+            UnsignedInt vertexCount;
+            MeshIndexType indexType;
+            std::size_t indexOffset;
+            UnsignedInt indexCount;
+            VertexFormat textureCoordinateFormat;
+            std::size_t textureCoordinateOffset;
+            Int textureCoordinateStride;
         };
 
         struct SkinMeshAsset {
-            SkinAsset* skin;
+            /* Index into the skeleton's skins, -1 if not skinned */
+            Int skinId;
             GL::Mesh* mesh;
             MaterialAsset* material;
             UnsignedInt perVertexJointCounts;
             UnsignedInt perVertexJointCountsSecondary;
+            /* Null if the mesh can't be skinned ahead of drawing */
+            SkinningSource* skinningSource;
+            /* Of the vertices as loaded, in the bind pose if skinned */
+            Range3D bounds;
         };
 
         struct SkinMeshNode {
             Containers::String name;
             Matrix4 transform{Math::IdentityInit};
-            SkinMeshAsset skinMesh{};
+            SkinMeshAsset skinMesh{-1, nullptr, nullptr, 0, 0, nullptr, {}};
             Containers::Array<SkinMeshNode> children{};
 
             explicit SkinMeshNode(const Containers::String &name): name(name) {}
         };
 
         //Animation asset data
+        /* Per mesh, declared first so the meshes using their buffers go
+           away before them */
+        Containers::Array<Containers::Optional<SkinningSource>> _skinningSources{};
         Containers::Array<GL::Mesh> _meshes{};
         Containers::Array<GL::Texture2D> _textures{};
         Containers::Array<MaterialAsset> _materials{};
-        Containers::Array<SkinAsset> _skins{};
+        SkeletonAsset _skeleton;
         SkinMeshNode _rootSkinMeshNode{"ROOT"};
-        std::map<Containers::String,Trade::AnimationData> _animations{};
-        Bone _rootBone{"ROOT"};
-        std::map<int,Bone&> _bonesById{};
+        /* Looked up by StringView without allocating a String */
+        std::map<Containers::String, AnimationClip, std::less<>> _clips{};
 
         explicit AnimatorAsset(Trade::AbstractImporter &importer);
     };
@@ -0,0 +1,30 @@
+#include "AssetPaths.h"
+
+#include <Corrade/Containers/Pair.h>
+#include <Corrade/Utility/Debug.h>
+#include <Corrade/Utility/Path.h>
+
+namespace MagnumGame {
+
+    Containers::Optional<Containers::String> findAssetDirectory(Containers::StringView dirName) {
+        using namespace Corrade::Utility;
+
+        if (auto currentDir = Path::currentDirectory()) {
+            auto dir = *currentDir;
+            while (true) {
+                auto candidateDir = Path::join(dir, dirName);
+                if (Path::exists(candidateDir) && Path::isDirectory(candidateDir)) {
+                    Debug{} << "Found" << candidateDir << "directory";
+                    return candidateDir;
+                }
+                auto parentDir = Path::split(dir).first();
+                if (dir == parentDir) {
+                    break;
+                }
+                dir = parentDir;
+            }
+        }
+        Error{} << "Found no" << dirName << "directory, looking in upwards from current" << Path::currentDirectory();
+        return {};
+    }
+}
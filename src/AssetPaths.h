@@ -0,0 +1,14 @@
+#pragma once
+
+#include <Corrade/Containers/Optional.h>
+#include <Corrade/Containers/String.h>
+#include <Corrade/Containers/StringView.h>
+
+namespace MagnumGame {
+    using namespace Corrade;
+
+    /**
+     * @brief Finds an asset directory such as "models" in the current directory or any of its parents
+     */
+    Containers::Optional<Containers::String> findAssetDirectory(Containers::StringView dirName);
+}
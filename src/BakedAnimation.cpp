@@ -0,0 +1,76 @@
+#include "BakedAnimation.h"
+
+#include <cmath>
+#include <Magnum/ImageView.h>
+#include <Magnum/PixelFormat.h>
+#include <Magnum/GL/TextureFormat.h>
+#include <Magnum/Math/Functions.h>
+
+#include "AnimatorAsset.h"
+#include "JointMatrixTexture.h"
+
+namespace MagnumGame {
+
+    BakedAnimation::BakedAnimation(const AnimatorAsset &asset) {
+        constexpr Int MatricesPerRow = JointMatrixTexture::MatricesPerRow;
+        const auto& skeleton = asset._skeleton;
+        const auto& skins = skeleton.getSkins();
+
+        /* Frames of a loop, the last one blends back into the first */
+        auto frameCountFor = [](const AnimationClip& clip) {
+            return UnsignedInt(Math::max(std::lround(clip.getDuration().size() * FramesPerSecond), 1l));
+        };
+
+        std::size_t jointsPerFrame = 0;
+        for (auto& skin : skins) jointsPerFrame += skin.jointBones.size();
+        std::size_t matrixCount = 0;
+        for (auto& [name, clip] : asset._clips) matrixCount += frameCountFor(clip) * jointsPerFrame;
+
+        _textureRows = Int(Math::max<std::size_t>((matrixCount + MatricesPerRow - 1) / MatricesPerRow, 1));
+        Containers::Array<Matrix4> matrices{ValueInit, std::size_t(_textureRows) * MatricesPerRow};
+
+        SkeletonPose pose{skeleton};
+        UnsignedInt offset = 0;
+        for (auto& [name, clip] : asset._clips) {
+            Clip baked{frameCountFor(clip), Containers::Array<UnsignedInt>{NoInit, skins.size()}};
+            for (std::size_t skin = 0; skin < skins.size(); skin++) {
+                baked.skinOffsets[skin] = offset;
+                offset += baked.frameCount * UnsignedInt(skins[skin].jointBones.size());
+            }
+
+            for (UnsignedInt frame = 0; frame < baked.frameCount; frame++) {
+                pose.resetToDefault();
+                clip.sample(clip.getDuration().min() + clip.getDuration().size() * Float(frame) / Float(baked.frameCount), pose);
+                pose.computeModelMatrices();
+                for (std::size_t skin = 0; skin < skins.size(); skin++) {
+                    const std::size_t jointCount = skins[skin].jointBones.size();
+                    pose.writeJointMatrices(skins[skin], matrices.sliceSize(baked.skinOffsets[skin] + frame * jointCount, jointCount));
+                }
+            }
+
+            _clips.emplace(name, std::move(baked));
+        }
+
+        _texture.setMinificationFilter(GL::SamplerFilter::Nearest)
+                .setMagnificationFilter(GL::SamplerFilter::Nearest)
+                .setWrapping(GL::SamplerWrapping::ClampToEdge)
+                .setStorage(1, GL::TextureFormat::RGBA32F, {MatricesPerRow * 4, _textureRows})
+                .setSubImage(0, {}, ImageView2D{PixelFormat::RGBA32F, {MatricesPerRow * 4, _textureRows}, Containers::arrayView(matrices)});
+        CHECK_GL_ERROR();
+
+        Debug{} << "Baked" << _clips.size() << "clips at" << FramesPerSecond << "frames per second into" << getByteSize() << "bytes";
+    }
+
+    const BakedAnimation::Clip* BakedAnimation::getClip(Containers::StringView name) const {
+        auto found = _clips.find(name);
+        return found == _clips.end() ? nullptr : &found->second;
+    }
+
+    std::size_t BakedAnimation::getByteSize() const {
+        return std::size_t(_textureRows) * JointMatrixTexture::MatricesPerRow * sizeof(Matrix4);
+    }
+
+    void BakedAnimation::bind() {
+        _texture.bind(TextureUnit);
+    }
+}
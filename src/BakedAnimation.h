@@ -0,0 +1,63 @@
+#pragma once
+
+#include <map>
+#include <Corrade/Containers/Array.h>
+#include <Corrade/Containers/String.h>
+#include <Magnum/GL/Texture.h>
+
+#include "MagnumGameCommon.h"
+
+namespace MagnumGame {
+    struct AnimatorAsset;
+
+    /* What drawing one skin of a character needs to play a baked clip */
+    struct BakedPlayback {
+        /* First matrix of the clip for this skin */
+        UnsignedInt clipOffset{};
+        UnsignedInt jointCount{};
+        UnsignedInt frameCount{};
+        /* Position in frames, interpolated between the two around it */
+        Float frame{};
+    };
+
+    /**
+     * @brief Every clip of an asset sampled into joint matrices on load
+     *
+     * Each clip is sampled FramesPerSecond times a second over one loop,
+     * frame after frame of joint matrices per skin, in a float texture laid
+     * out like JointMatrixTexture. Characters playing from it only move
+     * their clip time on the CPU, the vertex shader fetches and blends the
+     * two frames around it.
+     */
+    class BakedAnimation {
+    public:
+        /* Read when baking */
+        inline static Float FramesPerSecond = 30.0f;
+        static constexpr Int TextureUnit = 3;
+
+        struct Clip {
+            UnsignedInt frameCount;
+            /* First matrix of the clip for each skin of the skeleton */
+            Containers::Array<UnsignedInt> skinOffsets;
+        };
+
+        explicit BakedAnimation(const AnimatorAsset& asset);
+
+        DISALLOW_COPY(BakedAnimation)
+
+        /* Null if the asset has no such clip */
+        const Clip* getClip(Containers::StringView name) const;
+
+        std::size_t getClipCount() const { return _clips.size(); }
+
+        /* Size of the texture */
+        std::size_t getByteSize() const;
+
+        void bind();
+
+    private:
+        std::map<Containers::String, Clip, std::less<>> _clips;
+        GL::Texture2D _texture;
+        Int _textureRows{};
+    };
+}
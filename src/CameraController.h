@@ -21,9 +21,12 @@ namespace MagnumGame {
             return _camera.projectionMatrix() * _camera.cameraMatrix();
         };
         Matrix4 getCameraMatrix() const { return _camera.cameraMatrix(); }
+        Matrix4 getProjectionMatrix() const { return _camera.projectionMatrix(); }
 
         void draw(SceneGraph::DrawableGroup3D& drawableGroup) const { _camera.draw(drawableGroup); }
 
+        SceneGraph::Camera3D& getCamera() const { return _camera; }
+
         void rotateFromPointer(Vector2 delta);
 
         Math::Matrix4<Float> getCameraObjectMatrix() const { return _cameraObject.absoluteTransformationMatrix(); }
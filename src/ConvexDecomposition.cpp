@@ -0,0 +1,278 @@
+#include "ConvexDecomposition.h"
+
+#include <algorithm>
+#include <cmath>
+#include <btBulletDynamicsCommon.h>
+#include <BulletCollision/CollisionShapes/btShapeHull.h>
+#include <Corrade/Containers/GrowableArray.h>
+#include <LinearMath/btConvexHullComputer.h>
+#include <Magnum/Math/Functions.h>
+#include <Magnum/Math/Range.h>
+
+namespace MagnumGame {
+
+    namespace {
+        struct Plane {
+            /* Pointing out of the hull */
+            Vector3 normal;
+            Float distance;
+        };
+
+        struct Part {
+            Containers::Array<UnsignedInt> triangles;
+            /* Welded vertex ids used by the triangles */
+            Containers::Array<UnsignedInt> vertices;
+            Containers::Array<Vector3> hull;
+            Float concavity;
+            Vector3 deepestPoint;
+        };
+
+        class Decomposer {
+        public:
+            Decomposer(Containers::ArrayView<const Vector3> positions, Containers::ArrayView<const UnsignedInt> indices)
+                : _positions{positions}, _indices{indices},
+                  _welded{NoInit, positions.size()}, _vertexStamps{ValueInit, positions.size()} {}
+
+            Containers::Array<Part> run() {
+                Containers::Array<Part> parts;
+                if (_positions.isEmpty()) return parts;
+
+                weldVertices();
+
+                auto bounds = Range3D::fromSize(_positions[0], {});
+                for (auto& position : _positions) bounds = Math::join(bounds, Range3D::fromSize(position, {}));
+                _concavityThreshold = ConvexDecomposition::MaxConcavity * bounds.size().length();
+
+                if (_indices.size() < 3) {
+                    auto& part = arrayAppend(parts, InPlaceInit);
+                    for (UnsignedInt i = 0; i < _positions.size(); i++) {
+                        if (_welded[i] == i) arrayAppend(part.vertices, i);
+                    }
+                    computeHull(part);
+                    /* Nothing to split along without triangles */
+                    part.concavity = 0.0f;
+                    return parts;
+                }
+
+                parts = findConnectedParts();
+                for (auto& part : parts) {
+                    collectVertices(part);
+                    computeHull(part);
+                }
+
+                while (parts.size() < std::size_t(ConvexDecomposition::MaxHulls)) {
+                    auto mostConcave = std::max_element(parts.begin(), parts.end(), [](const Part& a, const Part& b) {
+                        return a.concavity < b.concavity;
+                    });
+                    if (mostConcave->concavity <= _concavityThreshold) break;
+
+                    Part first, second;
+                    if (!split(*mostConcave, first, second)) {
+                        mostConcave->concavity = 0.0f;
+                        continue;
+                    }
+                    *mostConcave = std::move(first);
+                    arrayAppend(parts, std::move(second));
+                }
+                return parts;
+            }
+
+        private:
+            void weldVertices() {
+                /* glTF splits vertices along UV and normal seams, which would
+                   otherwise make every face its own connected piece */
+                Containers::Array<UnsignedInt> order{NoInit, _positions.size()};
+                for (UnsignedInt i = 0; i < order.size(); i++) order[i] = i;
+                std::sort(order.begin(), order.end(), [&](UnsignedInt a, UnsignedInt b) {
+                    const auto& pa = _positions[a];
+                    const auto& pb = _positions[b];
+                    if (pa.x() != pb.x()) return pa.x() < pb.x();
+                    if (pa.y() != pb.y()) return pa.y() < pb.y();
+                    return pa.z() < pb.z();
+                });
+                _welded[order[0]] = order[0];
+                for (std::size_t i = 1; i < order.size(); i++) {
+                    _welded[order[i]] = _positions[order[i]] == _positions[order[i - 1]] ? _welded[order[i - 1]] : order[i];
+                }
+            }
+
+            Containers::Array<Part> findConnectedParts() {
+                Containers::Array<UnsignedInt> parents{NoInit, _positions.size()};
+                for (UnsignedInt i = 0; i < parents.size(); i++) parents[i] = i;
+                auto find = [&](UnsignedInt i) {
+                    while (parents[i] != i) {
+                        parents[i] = parents[parents[i]];
+                        i = parents[i];
+                    }
+                    return i;
+                };
+
+                const auto triangleCount = UnsignedInt(_indices.size() / 3);
+                for (UnsignedInt t = 0; t < triangleCount; t++) {
+                    auto root = find(_welded[_indices[t * 3]]);
+                    for (UnsignedInt corner = 1; corner < 3; corner++) {
+                        parents[find(_welded[_indices[t * 3 + corner]])] = root;
+                    }
+                }
+
+                Containers::Array<Int> rootParts{DirectInit, _positions.size(), -1};
+                Containers::Array<Part> parts;
+                for (UnsignedInt t = 0; t < triangleCount; t++) {
+                    auto root = find(_welded[_indices[t * 3]]);
+                    if (rootParts[root] == -1) {
+                        rootParts[root] = Int(parts.size());
+                        arrayAppend(parts, InPlaceInit);
+                    }
+                    arrayAppend(parts[rootParts[root]].triangles, t);
+                }
+                return parts;
+            }
+
+            void collectVertices(Part& part) {
+                _stamp++;
+                for (auto t : part.triangles) {
+                    for (UnsignedInt corner = 0; corner < 3; corner++) {
+                        auto vertex = _welded[_indices[t * 3 + corner]];
+                        if (_vertexStamps[vertex] == _stamp) continue;
+                        _vertexStamps[vertex] = _stamp;
+                        arrayAppend(part.vertices, vertex);
+                    }
+                }
+            }
+
+            void computeHull(Part& part) {
+                Containers::Array<Vector3> points{NoInit, part.vertices.size()};
+                for (std::size_t i = 0; i < points.size(); i++) points[i] = _positions[part.vertices[i]];
+
+                btConvexHullComputer computer;
+                computer.compute(points.data()->data(), sizeof(Vector3), int(points.size()), 0.0f, 0.0f);
+
+                part.hull = Containers::Array<Vector3>{NoInit, std::size_t(computer.vertices.size())};
+                Vector3 centroid;
+                for (int i = 0; i < computer.vertices.size(); i++) {
+                    auto& v = computer.vertices[i];
+                    part.hull[i] = Vector3{v.x(), v.y(), v.z()};
+                    centroid += part.hull[i];
+                }
+                if (!part.hull.isEmpty()) centroid /= Float(part.hull.size());
+
+                Containers::Array<Plane> planes;
+                for (int f = 0; f < computer.faces.size(); f++) {
+                    auto edge = &computer.edges[computer.faces[f]];
+                    auto next = edge->getNextEdgeOfFace();
+                    auto a = part.hull[edge->getSourceVertex()];
+                    auto b = part.hull[edge->getTargetVertex()];
+                    auto c = part.hull[next->getTargetVertex()];
+                    auto normal = Math::cross(b - a, c - b);
+                    if (normal.dot() < 1.0e-12f) continue;
+                    normal = normal.normalized();
+                    Plane plane{normal, -Math::dot(normal, a)};
+                    if (Math::dot(plane.normal, centroid) + plane.distance > 0.0f) {
+                        plane.normal = -plane.normal;
+                        plane.distance = -plane.distance;
+                    }
+                    arrayAppend(planes, plane);
+                }
+
+                /* Depth of every vertex below the hull surface, all zero for a
+                   convex part */
+                part.concavity = 0.0f;
+                if (planes.isEmpty()) return;
+                for (auto& point : points) {
+                    Float depth = Constants::inf();
+                    for (auto& plane : planes) {
+                        depth = Math::min(depth, -(Math::dot(plane.normal, point) + plane.distance));
+                    }
+                    if (depth > part.concavity) {
+                        part.concavity = depth;
+                        part.deepestPoint = point;
+                    }
+                }
+            }
+
+            Vector3 triangleCentroid(UnsignedInt t) const {
+                return (_positions[_indices[t * 3]] + _positions[_indices[t * 3 + 1]] + _positions[_indices[t * 3 + 2]]) / 3.0f;
+            }
+
+            bool split(const Part& part, Part& first, Part& second) {
+                auto bounds = Range3D::fromSize(_positions[part.vertices[0]], {});
+                for (auto vertex : part.vertices) bounds = Math::join(bounds, Range3D::fromSize(_positions[vertex], {}));
+                auto size = bounds.size();
+                Int axis = size.x() >= size.y() && size.x() >= size.z() ? 0 : (size.y() >= size.z() ? 1 : 2);
+
+                /* Cut through the deepest point, which usually sits in the
+                   notch of the concavity, or through the middle if all
+                   triangles end up on one side of it */
+                for (Float position : {part.deepestPoint[axis], bounds.center()[axis]}) {
+                    first = {};
+                    second = {};
+                    for (auto t : part.triangles) {
+                        arrayAppend(triangleCentroid(t)[axis] < position ? first.triangles : second.triangles, t);
+                    }
+                    if (!first.triangles.isEmpty() && !second.triangles.isEmpty()) {
+                        collectVertices(first);
+                        computeHull(first);
+                        collectVertices(second);
+                        computeHull(second);
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            Containers::ArrayView<const Vector3> _positions;
+            Containers::ArrayView<const UnsignedInt> _indices;
+            Containers::Array<UnsignedInt> _welded;
+            Containers::Array<UnsignedInt> _vertexStamps;
+            UnsignedInt _stamp{};
+            Float _concavityThreshold{};
+        };
+
+        Containers::Array<Vector3> reduceHull(Containers::Array<Vector3>&& hull) {
+            const auto budget = std::size_t(Math::max(ConvexDecomposition::MaxHullVertices, 4));
+            if (hull.size() <= budget) return std::move(hull);
+
+            btConvexHullShape shape{hull.data()->data(), int(hull.size()), sizeof(Vector3)};
+            /* btShapeHull samples the support function, which includes the margin */
+            shape.setMargin(0.0f);
+            btShapeHull shapeHull{&shape};
+            shapeHull.buildHull(0.0f);
+
+            Containers::Array<Vector3> reduced;
+            for (int i = 0; i < shapeHull.numVertices(); i++) {
+                auto& v = shapeHull.getVertexPointer()[i];
+                arrayAppend(reduced, Vector3{v.x(), v.y(), v.z()});
+            }
+            if (reduced.size() <= budget) return reduced;
+
+            /* btShapeHull keeps up to 42 support points, keep only the ones
+               found from budget directions spread evenly over the sphere */
+            Containers::Array<Vector3> sampled;
+            const Float goldenAngle = Constants::pi() * (3.0f - std::sqrt(5.0f));
+            for (std::size_t i = 0; i < budget; i++) {
+                Float y = 1.0f - 2.0f * (Float(i) + 0.5f) / Float(budget);
+                Float radius = std::sqrt(1.0f - y * y);
+                Float angle = goldenAngle * Float(i);
+                Vector3 direction{radius * std::cos(angle), y, radius * std::sin(angle)};
+
+                auto support = std::max_element(reduced.begin(), reduced.end(), [&](const Vector3& a, const Vector3& b) {
+                    return Math::dot(a, direction) < Math::dot(b, direction);
+                });
+                if (std::find(sampled.begin(), sampled.end(), *support) == sampled.end()) {
+                    arrayAppend(sampled, *support);
+                }
+            }
+            return sampled;
+        }
+    }
+
+    ConvexDecomposition::ConvexDecomposition(Containers::ArrayView<const Vector3> positions,
+                                             Containers::ArrayView<const UnsignedInt> indices)
+        : _inputVertexCount{UnsignedInt(positions.size())} {
+
+        for (auto& part : Decomposer{positions, indices}.run()) {
+            auto& hull = arrayAppend(_hulls, reduceHull(std::move(part.hull)));
+            _outputVertexCount += UnsignedInt(hull.size());
+        }
+    }
+}
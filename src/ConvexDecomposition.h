@@ -0,0 +1,45 @@
+#pragma once
+
+#include <Corrade/Containers/Array.h>
+#include <Corrade/Containers/ArrayView.h>
+#include <Magnum/Math/Vector3.h>
+
+#include "MagnumGameCommon.h"
+
+namespace MagnumGame {
+
+    /**
+     * @brief Splits a triangle mesh into convex hulls with a capped vertex count
+     *
+     * Every connected piece of the mesh starts as one part. The part whose
+     * vertices lie deepest inside its own convex hull is split in two along
+     * its longest axis, through that deepest point, until all parts are convex
+     * enough or @ref MaxHulls is reached. Each hull is then reduced with
+     * btShapeHull to @ref MaxHullVertices. Holds no GL state.
+     */
+    class ConvexDecomposition {
+    public:
+        /* Hulls a mesh may be split into, separate connected pieces always get
+           their own hull even beyond that */
+        inline static Int MaxHulls = 8;
+        /* How deep a vertex may lie inside the hull of its part before the
+           part gets split, relative to the mesh bounding box diagonal */
+        inline static Float MaxConcavity = 0.05f;
+        /* Vertex budget of every hull */
+        inline static Int MaxHullVertices = 32;
+
+        /* With no @p indices all positions go into a single hull */
+        explicit ConvexDecomposition(Containers::ArrayView<const Vector3> positions,
+                                     Containers::ArrayView<const UnsignedInt> indices);
+
+        const Containers::Array<Containers::Array<Vector3>>& getHulls() const { return _hulls; }
+
+        UnsignedInt getInputVertexCount() const { return _inputVertexCount; }
+        UnsignedInt getOutputVertexCount() const { return _outputVertexCount; }
+
+    private:
+        Containers::Array<Containers::Array<Vector3>> _hulls{};
+        UnsignedInt _inputVertexCount{};
+        UnsignedInt _outputVertexCount{};
+    };
+}
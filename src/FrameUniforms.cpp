@@ -0,0 +1,62 @@
+#include "FrameUniforms.h"
+
+#include <Corrade/Containers/GrowableArray.h>
+#include <Corrade/Containers/StringStl.h>
+#include <Corrade/Utility/Path.h>
+#include <Magnum/GL/Shader.h>
+
+#include "GameShader.h"
+#include "ShadowCasterShader.h"
+
+namespace MagnumGame {
+
+    void FrameUniforms::addShaderSource(GL::Shader &shader, Containers::StringView shadersDir) {
+        shader.addSource("#define MAX_SHADOWMAP_LEVELS " + std::to_string(FrameUniformData::MaxShadowLevels) + "\n");
+        if (UseUniformBuffers) shader.addSource("#define UNIFORM_BUFFERS 1\n");
+        shader.addFile(Utility::Path::join(shadersDir, "FrameUniforms.glsl"));
+    }
+
+    FrameUniforms::FrameUniforms(UnsignedInt viewCount) : _viewCount{viewCount} {
+        if (!UseUniformBuffers) return;
+
+        const auto alignment = std::size_t(GL::Buffer::uniformOffsetAlignment());
+        _viewStride = (sizeof(ViewUniformData) + alignment - 1) / alignment * alignment;
+
+        _frameBuffer = GL::Buffer{GL::Buffer::TargetHint::Uniform};
+        _frameBuffer.setData({nullptr, sizeof(FrameUniformData)}, GL::BufferUsage::DynamicDraw);
+        _viewBuffer = GL::Buffer{GL::Buffer::TargetHint::Uniform};
+        _viewBuffer.setData({nullptr, _viewStride * _viewCount}, GL::BufferUsage::DynamicDraw);
+        CHECK_GL_ERROR();
+    }
+
+    void FrameUniforms::addShader(GameShader &shader) {
+        arrayAppend(_gameShaders, &shader);
+    }
+
+    void FrameUniforms::addShader(ShadowCasterShader &shader) {
+        arrayAppend(_shadowCasterShaders, &shader);
+    }
+
+    void FrameUniforms::setFrame(const FrameUniformData &data) {
+        if (UseUniformBuffers) {
+            _frameBuffer.setSubData(0, Containers::arrayView(&data, 1));
+            _frameBuffer.bind(GL::Buffer::Target::Uniform, FrameBinding);
+        } else {
+            for (auto* shader : _gameShaders) shader->setFrameUniforms(data);
+        }
+        CHECK_GL_ERROR();
+    }
+
+    void FrameUniforms::setView(UnsignedInt view, const Matrix4 &projectionMatrix) {
+        CORRADE_INTERNAL_ASSERT(view < _viewCount);
+        if (UseUniformBuffers) {
+            const ViewUniformData data{projectionMatrix};
+            _viewBuffer.setSubData(view * _viewStride, Containers::arrayView(&data, 1));
+            _viewBuffer.bind(GL::Buffer::Target::Uniform, ViewBinding, view * _viewStride, sizeof(ViewUniformData));
+        } else {
+            for (auto* shader : _gameShaders) shader->setProjectionMatrix(projectionMatrix);
+            for (auto* shader : _shadowCasterShaders) shader->setProjectionMatrix(projectionMatrix);
+        }
+        CHECK_GL_ERROR();
+    }
+}
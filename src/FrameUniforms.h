@@ -0,0 +1,82 @@
+#pragma once
+
+#include <Corrade/Containers/Array.h>
+#include <Corrade/Containers/StringView.h>
+#include <Magnum/GL/Buffer.h>
+#include <Magnum/GL/GL.h>
+#include <Magnum/Math/Matrix4.h>
+
+#include "MagnumGameCommon.h"
+
+namespace MagnumGame {
+    class GameShader;
+    class ShadowCasterShader;
+
+    /* Same for every draw of a frame, the std140 Frame block of
+       FrameUniforms.glsl */
+    struct FrameUniformData {
+        static constexpr std::size_t MaxShadowLevels = 4;
+
+        Matrix4 shadowmapMatrices[MaxShadowLevels];
+        /* In x, the block pads each array element to a vec4 */
+        Vector4 shadowDepthSplits[MaxShadowLevels];
+        Vector3 light;
+        Float shininess{};
+        Vector3 lightColor;
+        Float padding0{};
+        Vector3 ambientColor;
+        Float padding1{};
+    };
+
+    /* Same for every draw of a view, the std140 View block */
+    struct ViewUniformData {
+        Matrix4 projectionMatrix;
+    };
+
+    /**
+     * @brief Frame and view constants of every GameShader and ShadowCasterShader
+     *
+     * With uniform buffers the Frame block is uploaded once a frame and
+     * each view, the main camera and every shadow cascade, gets its own
+     * aligned range of the View buffer, bound before its draws. The shaders
+     * only get their per-object uniforms set per draw. Without, the same
+     * values are set as plain uniforms on every added shader instead, for
+     * contexts where uniform blocks are missing or broken.
+     */
+    class FrameUniforms {
+    public:
+        /* Read when shaders are compiled */
+        inline static bool UseUniformBuffers = true;
+
+        static constexpr UnsignedInt FrameBinding = 0;
+        static constexpr UnsignedInt ViewBinding = 1;
+
+        /* Adds the defines the blocks need and FrameUniforms.glsl from
+           @p shadersDir, before the shader's own source */
+        static void addShaderSource(GL::Shader& shader, Containers::StringView shadersDir);
+
+        explicit FrameUniforms(UnsignedInt viewCount);
+
+        DISALLOW_COPY(FrameUniforms)
+
+        /* Only used without uniform buffers */
+        void addShader(GameShader& shader);
+        void addShader(ShadowCasterShader& shader);
+
+        /* Uploads @p data for the draws that follow */
+        void setFrame(const FrameUniformData& data);
+
+        /* Uploads the projection of view @p view and makes the draws that
+           follow use it */
+        void setView(UnsignedInt view, const Matrix4& projectionMatrix);
+
+    private:
+        GL::Buffer _frameBuffer{NoCreate};
+        GL::Buffer _viewBuffer{NoCreate};
+        UnsignedInt _viewCount;
+        /* Size of a view rounded up to the uniform offset alignment */
+        std::size_t _viewStride{};
+        Containers::Array<GameShader*> _gameShaders;
+        Containers::Array<ShadowCasterShader*> _shadowCasterShaders;
+    };
+}
@@ -15,41 +15,22 @@
 #include <Magnum/Math/Color.h>
 #include <Corrade/Utility/Path.h>
 
+#include "AssetPaths.h"
 #include "GameShader.h"
+#include "JointMatrixTexture.h"
 #include "MagnumGameApp.h"
 #include "ShadowCasterShader.h"
+#include "SkinningShader.h"
 
 namespace MagnumGame {
 
     using namespace Magnum::Math::Literals;
 
-    static Containers::Optional<Containers::String> findDirectory(Containers::StringView dirName) {
-        using namespace Corrade::Utility;
-
-        if (auto currentDir = Path::currentDirectory()) {
-            auto dir = *currentDir;
-            while (true) {
-                auto candidateDir = Path::join(dir, dirName);
-                if (Path::exists(candidateDir) && Path::isDirectory(candidateDir)) {
-                    Debug{} << "Found" << candidateDir << "directory";
-                    return candidateDir;
-                }
-                auto parentDir = Path::split(dir).first();
-                if (dir == parentDir) {
-                    break;
-                }
-                dir = parentDir;
-            }
-        }
-        Error{} << "Found no" << dirName << "directory, looking in upwards from current" << Path::currentDirectory();
-        return {};
-    }
-
     GameAssets::GameAssets(Trade::AbstractImporter& importer){
 
-        _modelsDir = *findDirectory("models");
-        _fontsDir = *findDirectory("font");
-        _shadersDir = *findDirectory("shaders");
+        _modelsDir = *findAssetDirectory("models");
+        _fontsDir = *findAssetDirectory("font");
+        _shadersDir = *findAssetDirectory("shaders");
 
         _shadowCasterShader.emplace(
             Utility::Path::join(_shadersDir, "ShadowCaster.vert"),
@@ -57,7 +38,7 @@ namespace MagnumGame {
 
         _animatedShadowCasterShader.emplace(
             Utility::Path::join(_shadersDir, "ShadowCaster.vert"),
-            Utility::Path::join(_shadersDir, "ShadowCaster.frag"), MaxAnimationBones);
+            Utility::Path::join(_shadersDir, "ShadowCaster.frag"), JointMatrixTexture::MatricesPerRow);
 
         _texturedShader.emplace(
             Utility::Path::join(_shadersDir, "GameShader.vert"),
@@ -65,8 +46,19 @@ namespace MagnumGame {
 
         _animatedTexturedShader.emplace(
             Utility::Path::join(_shadersDir, "GameShader.vert"),
-            Utility::Path::join(_shadersDir, "GameShader.frag"), MaxAnimationBones, ShadowMapLevels, ShadowPercentageCloserFiltering);
-        _animatedTexturedShader->setAmbientColor(0x111111_rgbf);
+            Utility::Path::join(_shadersDir, "GameShader.frag"), JointMatrixTexture::MatricesPerRow, ShadowMapLevels, ShadowPercentageCloserFiltering);
+
+        _bakedShadowCasterShader.emplace(
+            Utility::Path::join(_shadersDir, "ShadowCaster.vert"),
+            Utility::Path::join(_shadersDir, "ShadowCaster.frag"), JointMatrixTexture::MatricesPerRow, true);
+
+        _bakedTexturedShader.emplace(
+            Utility::Path::join(_shadersDir, "GameShader.vert"),
+            Utility::Path::join(_shadersDir, "GameShader.frag"), JointMatrixTexture::MatricesPerRow, ShadowMapLevels, ShadowPercentageCloserFiltering, true);
+
+        _skinningShader.emplace(
+            Utility::Path::join(_shadersDir, "Skinning.vert"),
+            Utility::Path::join(_shadersDir, "Skinning.frag"), JointMatrixTexture::MatricesPerRow);
 
         _vertexColorShader.emplace();
 
@@ -8,9 +8,11 @@
 #include <Magnum/Trade/Trade.h>
 
 #include "Animator.h"
+#include "Player.h"
 
 namespace MagnumGame {
     class ShadowCasterShader;
+    class SkinningShader;
 
     using namespace Magnum;
 
@@ -18,7 +20,6 @@ namespace MagnumGame {
 public:
         static constexpr int ShadowMapLevels = 2;
         static constexpr bool ShadowPercentageCloserFiltering = true;
-        static constexpr int MaxAnimationBones = 16;
         static constexpr Vector2i ShadowMapResolution = {1024, 1024};
 
         explicit GameAssets(Trade::AbstractImporter& );
@@ -36,7 +37,10 @@ public:
         auto& getShadowCasterShader() { return *_shadowCasterShader; }
         auto& getAnimatedShadowCasterShader() { return *_animatedShadowCasterShader; }
         auto& getAnimatedTexturedShader() { return *_animatedTexturedShader; }
+        auto& getBakedShadowCasterShader() { return *_bakedShadowCasterShader; }
+        auto& getBakedTexturedShader() { return *_bakedTexturedShader; }
         auto& getTexturedShader() { return *_texturedShader; }
+        auto& getSkinningShader() { return *_skinningShader; }
         auto& getVertexColorShader() { return *_vertexColorShader; }
 
         Containers::StringView getModelsDir() const { return _modelsDir; }
@@ -53,10 +57,13 @@ public:
         Containers::Pointer<ShadowCasterShader> _animatedShadowCasterShader{};
         Containers::Pointer<GameShader> _texturedShader{};
         Containers::Pointer<GameShader> _animatedTexturedShader{};
+        Containers::Pointer<ShadowCasterShader> _bakedShadowCasterShader{};
+        Containers::Pointer<GameShader> _bakedTexturedShader{};
+        Containers::Pointer<SkinningShader> _skinningShader{};
         Containers::Pointer<Shaders::VertexColorGL3D> _vertexColorShader{};
 
         btStaticPlaneShape _bGroundShape{{0,1,0},0};
-        btCapsuleShape _bPlayerShape{0.125, 0.5};
+        btCapsuleShape _bPlayerShape{Player::CapsuleRadius, Player::CapsuleHeight};
         Containers::Pointer<AnimatorAsset> _playerAsset{};
 
 
@@ -10,26 +10,33 @@
 #include <Magnum/GL/Renderer.h>
 #include <Corrade/Utility/DebugStl.h>
 #include <Corrade/Containers/Reference.h>
+#include <Corrade/Containers/Pair.h>
+#include <Corrade/Containers/StringStl.h>
+#include <Corrade/Utility/Path.h>
 #include <iostream>
 
+#include "JointMatrixTexture.h"
 #include "MagnumGameCommon.h"
 
 namespace MagnumGame {
 
 	using namespace Magnum::GL;
 
-GameShader::GameShader(const std::string& vertFilename, const std::string& fragFilename, int maxAnimationBones, int shadowMapLevels, bool shadowPcf)
+GameShader::GameShader(const std::string& vertFilename, const std::string& fragFilename, int jointMatricesPerRow, int shadowMapLevels, bool shadowPcf, bool bakedAnimation)
 {
 	CHECK_GL_ERROR();
 	if (shadowMapLevels > 0) {
 		addDefine("ENABLE_SHADOWMAP_LEVELS",std::to_string(shadowMapLevels));
 	}
-	if (maxAnimationBones > 0) {
-		addDefine("ENABLE_MAX_ANIMATION_BONES",std::to_string(maxAnimationBones));
+	if (jointMatricesPerRow > 0) {
+		addDefine("JOINT_MATRICES_PER_ROW",std::to_string(jointMatricesPerRow));
 	}
 	if (shadowPcf) {
 		addDefine("SHADOWMAP_PCF", "1");
 	}
+	if (bakedAnimation) {
+		addDefine("BAKED_ANIMATION", "1");
+	}
 
 	CHECK_GL_ERROR();
 	using namespace Magnum;
@@ -45,6 +52,9 @@ GameShader::GameShader(const std::string& vertFilename, const std::string& fragF
 	frag.addSource(preamble);
 	CHECK_GL_ERROR();
 	preamble = "";
+	const auto shadersDir = Utility::Path::split(vertFilename).first();
+	FrameUniforms::addShaderSource(vert, shadersDir);
+	FrameUniforms::addShaderSource(frag, shadersDir);
 	vert.addFile(vertFilename);
     frag.addFile(fragFilename);
 	CHECK_GL_ERROR();
@@ -79,6 +89,11 @@ GameShader::GameShader(const std::string& vertFilename, const std::string& fragF
 	}
 	CHECK_GL_ERROR();
 
+	if (FrameUniforms::UseUniformBuffers) {
+		setUniformBlockBinding(uniformBlockIndex("Frame"), FrameUniforms::FrameBinding);
+		setUniformBlockBinding(uniformBlockIndex("View"), FrameUniforms::ViewBinding);
+	}
+
 	transformationMatrixUniform = uniformLocation("transformationMatrix");
 	projectionMatrixUniform = uniformLocation("projectionMatrix");
 	normalMatrixUniform = uniformLocation("normalMatrix");
@@ -89,8 +104,17 @@ GameShader::GameShader(const std::string& vertFilename, const std::string& fragF
 	lightColorUniform = uniformLocation("lightColor");
 	shininessUniform = uniformLocation("shininess");
 	ambientColorUniform = uniformLocation("ambientColor");
-	jointMatricesUniform = uniformLocation("jointMatrices");
+	jointMatrixOffsetUniform = uniformLocation("jointMatrixOffset");
 	perVertexJointCountUniform = uniformLocation("perVertexJointCount");
+	bakedClipOffsetUniform = uniformLocation("bakedClipOffset");
+	bakedJointCountUniform = uniformLocation("bakedJointCount");
+	bakedFrameCountUniform = uniformLocation("bakedFrameCount");
+	bakedFrameUniform = uniformLocation("bakedFrame");
+	if (bakedAnimation) {
+		setUniform(uniformLocation("bakedAnimationTexture"), BakedAnimation::TextureUnit);
+	} else if (jointMatricesPerRow > 0) {
+		setUniform(uniformLocation("jointMatrixTexture"), JointMatrixTexture::TextureUnit);
+	}
 
 
 	specularColorUniform = uniformLocation("specularColor");
@@ -120,6 +144,16 @@ GameShader& GameShader::setDiffuseTexture(Magnum::GL::Texture2D& texture) {
     return *this;
 }
 
+GameShader& GameShader::setFrameUniforms(const FrameUniformData& data) {
+	setUniform(shadowmapMatrixUniform, Containers::arrayView(data.shadowmapMatrices));
+	setUniform(shadowCutPlanesUniform, Containers::arrayView(data.shadowDepthSplits));
+	setUniform(lightVectorUniform, data.light);
+	setUniform(shininessUniform, data.shininess);
+	setUniform(lightColorUniform, data.lightColor);
+	setUniform(ambientColorUniform, data.ambientColor);
+	return *this;
+}
+
 GameShader& GameShader::setShadowmapTexture(Magnum::GL::Texture2DArray& texture) {
     texture.bind(ShadowmapTextureLayer);
     return *this;
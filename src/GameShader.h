@@ -10,6 +10,9 @@
 #include <Corrade/Containers/ArrayView.h>
 #include <Magnum/Shaders/GenericGL.h>
 
+#include "BakedAnimation.h"
+#include "FrameUniforms.h"
+
 namespace MagnumGame {
 
 using namespace Magnum;
@@ -24,7 +27,7 @@ public:
 	typedef Shaders::GenericGL3D::JointIds JointIds;
 	typedef Shaders::GenericGL3D::Weights Weights;
 
-    explicit GameShader(const std::string& vertFilename, const std::string& fragFilename, int maxAnimationBones, int shadowMapLevels, bool shadowPcf);
+    explicit GameShader(const std::string& vertFilename, const std::string& fragFilename, int jointMatricesPerRow, int shadowMapLevels, bool shadowPcf, bool bakedAnimation = false);
 
 	~GameShader() override = default;
 
@@ -36,11 +39,6 @@ public:
 		ShadowmapTextureLayer = 1
 	};
 
-	GameShader& setAmbientColor(const Vector3& color) {
-		setUniform(ambientColorUniform, color);
-		return *this;
-	}
-
 	GameShader& setTransformationMatrix(const Matrix4& matrix) {
 		setUniform(transformationMatrixUniform, matrix);
 		return *this;
@@ -49,6 +47,7 @@ public:
 		setUniform(normalMatrixUniform, matrix);
 		return *this;
 	}
+	/* Only without FrameUniforms::UseUniformBuffers, see FrameUniforms */
 	GameShader& setProjectionMatrix(const Matrix4& matrix) {
 		setUniform(projectionMatrixUniform, matrix);
 		return *this;
@@ -59,31 +58,8 @@ public:
 		return *this;
 	}
 
-	GameShader& setShadowCutPlanes(const Corrade::Containers::ArrayView<const float>& shadowCutPlanes) {
-		setUniform(shadowCutPlanesUniform, shadowCutPlanes);
-		return *this;
-	}
-
-	GameShader& setShadowmapMatrices(const Corrade::Containers::ArrayView<Matrix4>& matrices) {
-		setUniform(shadowmapMatrixUniform, matrices);
-		return *this;
-	}
-
-	GameShader& setShadowmapMatrix(const Matrix4& matrix) {
-		setUniform(shadowmapMatrixUniform, matrix);
-		return *this;
-	}
-
-	GameShader& setLightVector(const Vector3& f) {
-		setUniform(lightVectorUniform, f);
-		return *this;
-	}
-	auto& setShininess(float shininess) { setUniform(shininessUniform, shininess); return *this; }
-
-	GameShader& setLightColor(const Vector3& f) {
-		setUniform(lightColorUniform, f);
-		return *this;
-	}
+	/* Only without FrameUniforms::UseUniformBuffers */
+	GameShader& setFrameUniforms(const FrameUniformData& data);
 
 	GameShader& setSpecularColor(const Vector3& f) {
 		setUniform(specularColorUniform, f);
@@ -96,8 +72,18 @@ public:
 		return *this;
 	}
 
-	GameShader& setJointMatrices(Containers::ArrayView<const Matrix4> array) {
-		setUniform(jointMatricesUniform, array);
+	/* First matrix of the skin in the JointMatrixTexture */
+	GameShader& setJointMatrixOffset(UnsignedInt offset) {
+		setUniform(jointMatrixOffsetUniform, offset);
+		return *this;
+	}
+
+	/* Only with bakedAnimation, in place of setJointMatrixOffset() */
+	GameShader& setBakedPlayback(const BakedPlayback& playback) {
+		setUniform(bakedClipOffsetUniform, playback.clipOffset);
+		setUniform(bakedJointCountUniform, playback.jointCount);
+		setUniform(bakedFrameCountUniform, playback.frameCount);
+		setUniform(bakedFrameUniform, playback.frame);
 		return *this;
 	}
 
@@ -117,7 +103,11 @@ private:
 		shininessUniform,
 		ambientColorUniform,
 		perVertexJointCountUniform,
-		jointMatricesUniform;
+		jointMatrixOffsetUniform,
+		bakedClipOffsetUniform,
+		bakedJointCountUniform,
+		bakedFrameCountUniform,
+		bakedFrameUniform;
 
 	std::string preamble;
 
@@ -1,13 +1,17 @@
 #include "GameState.h"
 
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <random>
 #include <sstream>
 #include <Corrade/Containers/GrowableArray.h>
 #include <Corrade/Containers/Reference.h>
 #include <Corrade/Utility/DebugStl.h>
 #include <Corrade/Utility/Path.h>
-#include <Corrade/Utility/String.h>
 #include <Corrade/Containers/StructuredBindings.h>
 #include <Magnum/GL/DefaultFramebuffer.h>
+#include <Magnum/Math/FunctionsBatch.h>
 #include <Magnum/MeshTools/Compile.h>
 #include <Magnum/Trade/LightData.h>
 #include <Magnum/Trade/MeshData.h>
@@ -22,16 +26,18 @@
 #include "GameShader.h"
 
 namespace MagnumGame {
+
+    static_assert(GameAssets::ShadowMapLevels <= Int(FrameUniformData::MaxShadowLevels),
+                  "the Frame uniform block has no room for that many shadow cascades");
+
     GameState::GameState(const Timeline& timeline, GameAssets& assets)
     : _timeline(timeline)
     , _assets(assets) {
         _bSphereQueryObject.setCollisionShape(&_bSphereQueryShape);
 
-        _bWorld.setGravity({0.0f, -10.0f, 0.0f});
-
         _debugDraw = BulletIntegration::DebugDraw{};
         _debugDraw.setMode(BulletIntegration::DebugDraw::Mode::DrawWireframe);
-        _bWorld.setDebugDrawer(&_debugDraw);
+        _physics.getWorld().setDebugDrawer(&_debugDraw);
 
         Range1D zPlanes{0.1f, 128.0f};
         _cameraController.emplace(_scene, zPlanes);
@@ -40,6 +46,13 @@ namespace MagnumGame {
 
         _shadowLight.emplace(_scene, zPlanes, GameAssets::ShadowMapLevels, GameAssets::ShadowMapResolution);
 
+        for (auto* shader : {&_assets.getTexturedShader(), &_assets.getAnimatedTexturedShader(), &_assets.getBakedTexturedShader()}) {
+            _frameUniforms.addShader(*shader);
+        }
+        for (auto* shader : {&_assets.getShadowCasterShader(), &_assets.getAnimatedShadowCasterShader(), &_assets.getBakedShadowCasterShader()}) {
+            _frameUniforms.addShader(*shader);
+        }
+
     }
 
     GameState::~GameState() = default;
@@ -53,76 +66,28 @@ namespace MagnumGame {
 
     void GameState::loadLevel(Trade::AbstractImporter &importer) {
 
-        const auto colliderSuffix = "-collider";
-
         auto filePath = Utility::Path::join(_assets.getModelsDir(), "levels/level-1.glb");
         if (!importer.openFile(filePath)) {
             Warning{} << "Can't open" << filePath << "with" << importer.plugin();
             return;
         }
 
-        arrayRemove(_levelShapes, 0, _levelShapes.size());
         arrayRemove(_levelMeshes, 0, _levelMeshes.size());
-        arrayReserve(_levelShapes, importer.meshCount());
         arrayReserve(_levelMeshes, importer.meshCount());
-
-        _meshToShapeMap.clear();
-
-        Containers::Array<UnsignedInt> meshToMeshCollider{NoInit, importer.meshCount()};
+        _levelMeshBounds = Containers::Array<Range3D>{ValueInit, importer.meshCount()};
         for (auto meshId = 0U; meshId < importer.meshCount(); meshId++) {
-            meshToMeshCollider[meshId] = meshId;
+            arrayAppend(_levelMeshes, InPlaceInit, InPlaceInit, NoCreate);
         }
 
-        Debug{} << "Meshes:" << importer.meshCount();
-        for (auto meshId = 0U; meshId < importer.meshCount(); meshId++) {
-            auto meshName = importer.meshName(meshId);
-            Debug debug{};
-            debug << "\tMesh" << meshId << ":" << meshName;
-            auto meshData = importer.mesh(meshId);
-
-            bool isCollider = Utility::String::endsWith(colliderSuffix, meshName);
-            if (isCollider) {
-                auto normalMeshName = Utility::String::stripSuffix(meshName, colliderSuffix);
-                auto normalMeshId = importer.meshForName(normalMeshName);
-                if (normalMeshId != -1) {
-                    debug << "is a collider for" << normalMeshId << normalMeshName;
-                    meshToMeshCollider[normalMeshId] = meshId;
-                } else {
-                    debug << "is a standalone collider";
-                }
-                auto meshPositions = meshData->positions3DAsArray();
-                meshToMeshCollider[meshId] = normalMeshId;
-                arrayAppend(_levelShapes, InPlaceInit, InPlaceInit, meshPositions.data()->data(), static_cast<int>(meshPositions.size()), sizeof(Vector3));
-                arrayAppend(_levelMeshes, InPlaceInit, InPlaceInit, NoCreate);
-            } else {
-                auto colliderName = meshName + colliderSuffix;
-                auto colliderId = importer.meshForName(colliderName);
-                bool hasCollider = colliderId != -1;
-                if (hasCollider) {
-                    meshToMeshCollider[meshId] = colliderId;
-                    arrayAppend(_levelShapes, InPlaceInit);
-                    debug << "has a collider" << colliderId << colliderName;
-                } else {
-                    auto meshPositions = meshData->positions3DAsArray();
-                    arrayAppend(_levelShapes, InPlaceInit, InPlaceInit, meshPositions.data()->data(),
-                                              static_cast<int>(meshPositions.size()), sizeof(Vector3));
-                    debug << "has no explicit collider, creating from mesh";
-                }
-                [[maybe_unused]]
-                auto& mesh = arrayAppend(_levelMeshes, InPlaceInit, InPlaceInit, MeshTools::compile(*meshData));
+        _levelCollision.loadShapes(importer, [&](UnsignedInt meshId, const Trade::MeshData& meshData) {
+            [[maybe_unused]]
+            auto& mesh = *(_levelMeshes[meshId] = Containers::Pointer<GL::Mesh>{InPlaceInit, MeshTools::compile(meshData)});
+            auto positions = meshData.positions3DAsArray();
+            if (!positions.isEmpty()) _levelMeshBounds[meshId] = Range3D{Math::minmax(positions)};
 #ifndef MAGNUM_TARGET_WEBGL
-                mesh->setLabel(meshName);
+            mesh.setLabel(importer.meshName(meshId));
 #endif
-            }
-        }
-
-        for (auto meshId = 0U; meshId < importer.meshCount(); meshId++) {
-            auto shapeId = meshToMeshCollider[meshId];
-            auto mesh = _levelMeshes[meshId].get();
-            auto shape = _levelShapes[shapeId].get();
-            _meshToShapeMap[mesh] = shape;
-            Debug{} << "Mesh" << meshId << importer.meshName(meshId) << "has shape" << shapeId << importer.meshName(shapeId);
-        }
+        });
 
         _levelTextures = GameAssets::loadTextures(importer);
 
@@ -159,30 +124,23 @@ namespace MagnumGame {
                         debug << "\tTransformation" << matrix->translation();
                     }
                 }
+            }
 
-                if (Utility::String::endsWith(objectName, colliderSuffix)) {
-                    continue;
-                }
-
-                for (auto &[meshId,materialId]: sceneData->meshesMaterialsFor(objectId)) {
+            _levelCollision.addObjects(importer, *sceneData, _scene, _physics.getWorld(),
+                [&](Object3D& object, UnsignedInt meshId, Int materialId) {
                     Debug{} << "\t\tMesh" << meshId << importer.meshName(meshId) << "Material" <<
                             materialId << (materialId == -1 ? "NONE" : importer.materialName(materialId));
 
                     auto mesh = _levelMeshes[meshId].get();
-                    auto shape = _meshToShapeMap[mesh];
-                    auto &rigidBody = _scene.addChild<RigidBody>(0.0f, shape, _bWorld, RigidBody::CollisionLayer::Terrain);
-
-
-                    if (auto matrix = sceneData->transformation3DFor(objectId)) {
-                        rigidBody.setTransformation(*matrix);
-                        rigidBody.syncPose();
-                    }
-
-                    rigidBody.addFeature<ShadowCasterDrawable>(_assets.getShadowCasterShader(), _shadowCasterDrawables).setMesh(mesh);
-                    rigidBody.addFeature<TexturedDrawable>(_levelMaterials[materialId].texture, _assets.getTexturedShader(), *mesh, _opaqueDrawables);
-                }
-            }
+                    auto& shadowCaster = object.addFeature<ShadowCasterDrawable>(_assets.getShadowCasterShader(), _shadowCasterDrawables)
+                            .setMesh(mesh)
+                            .setAABB(_levelMeshBounds[meshId]);
+                    auto& drawable = object.addFeature<TexturedDrawable>(_levelMaterials[materialId].texture, _assets.getTexturedShader(), *mesh, _opaqueDrawables)
+                            .setBounds(_levelMeshBounds[meshId]);
+                    addSceneObject(drawable, shadowCaster, false);
+                });
         }
+        _levelCollision.finish(_scene, _physics.getWorld(), filePath);
 
         CHECK_GL_ERROR();
     }
@@ -199,70 +157,222 @@ namespace MagnumGame {
             _shadowLight->setTarget(TexturedDrawable::lightDirection, cameraMatrix[2].xyz(), imvp);
         }
 
-        _shadowLight->render(_shadowCasterDrawables);
+        /* The first pass of a frame */
+        refitSceneBvh();
+
+        ShadowLight::CasterQuery query;
+        if (_useSceneBvh) query = [this](Containers::ArrayView<const Vector4> planes) {
+            arrayResize(_queryIds, NoInit, 0);
+            _sceneBvh.queryPlanes(planes, _queryIds);
+            arrayResize(_queryShadowCasters, NoInit, 0);
+            arrayReserve(_queryShadowCasters, _queryIds.size());
+            for (auto id : _queryIds) arrayAppend(_queryShadowCasters, _sceneObjects[id].shadowCaster);
+            return Containers::ArrayView<ShadowCasterDrawable* const>{_queryShadowCasters};
+        };
+        _shadowLight->render(_shadowCasterDrawables, _frameUniforms, query);
         CHECK_GL_ERROR();
 
         GL::Renderer::flush();
         CHECK_GL_ERROR();
 
-        auto setupShaderForShadows = [&](GameShader* shader) {
-            shader->setShadowmapTexture(_shadowLight->getShadowmapTextureArray());
-            CHECK_GL_ERROR();
-            shader->setShadowmapMatrices(_shadowLight->getShadowMatrices());
-            CHECK_GL_ERROR();
-            shader->setShadowCutPlanes(_shadowLight->getCutPlanes());
-            CHECK_GL_ERROR();
-            shader->setLightVector(_cameraController->getCameraMatrix().rotationScaling() * _shadowLight->transformation()[2].xyz());
-            CHECK_GL_ERROR();
-        };
-        setupShaderForShadows(&_assets.getTexturedShader());
-        setupShaderForShadows(&_assets.getAnimatedTexturedShader());
+        _assets.getTexturedShader().setShadowmapTexture(_shadowLight->getShadowmapTextureArray());
+        CHECK_GL_ERROR();
     }
 
     void GameState::drawOpaque() {
-        _cameraController->draw(_opaqueDrawables);
+        /* Once for every GameShader, what each draw used to set */
+        FrameUniformData frame;
+        if (_shadowLight) {
+            auto shadowMatrices = _shadowLight->getShadowMatrices();
+            auto& cutPlanes = _shadowLight->getCutPlanes();
+            for (std::size_t i = 0; i < shadowMatrices.size(); i++) {
+                frame.shadowmapMatrices[i] = shadowMatrices[i];
+                frame.shadowDepthSplits[i].x() = cutPlanes[i];
+            }
+        }
+        frame.light = TexturedDrawable::lightDirection;
+        frame.shininess = TexturedDrawable::shininess;
+        frame.lightColor = Vector3{TexturedDrawable::lightColor};
+        frame.ambientColor = Vector3{TexturedDrawable::ambientColor};
+        _frameUniforms.setFrame(frame);
+        _frameUniforms.setView(0, _cameraController->getProjectionMatrix());
+
+        if (_useSceneBvh) {
+            arrayResize(_queryIds, NoInit, 0);
+            _sceneBvh.queryFrustum(Frustum::fromMatrix(_cameraController->getTransformationProjectionMatrix()), _queryIds);
+            arrayResize(_queryDrawables, NoInit, 0);
+            arrayReserve(_queryDrawables, _queryIds.size());
+            for (auto id : _queryIds) arrayAppend(_queryDrawables, _sceneObjects[id].drawable);
+            _opaqueQueue.draw(_queryDrawables, _cameraController->getCamera());
+        } else {
+            _opaqueQueue.draw(_opaqueDrawables, _cameraController->getCamera());
+        }
         CHECK_GL_ERROR();
     }
 
     void GameState::drawTransparent() {
-        //Might want to sort the drawables along the camera Z axis
-        _cameraController->draw(_transparentDrawables);
+        _transparentQueue.draw(_transparentDrawables, _cameraController->getCamera());
         CHECK_GL_ERROR();
     }
 
-    void GameState::setupPlayer() {
-        RigidBody *rigidBody = &_scene.addChild<RigidBody>(1.0f, &_assets.getPlayerShape(), _bWorld,
-                                                           RigidBody::CollisionLayer::Dynamic);
-        auto& animationOffset = rigidBody->addChild<Object3D>();
-        Animator *animator = &animationOffset.addFeature<Animator>(*_assets.getPlayerAsset(), _assets.getAnimatedTexturedShader(),
-                                                                   &_animatorDrawables, &_opaqueDrawables);
+    Animator& GameState::addAnimator(Object3D &object, bool baked) {
+        if (baked && !_bakedAnimation) _bakedAnimation.emplace(*_assets.getPlayerAsset());
+
+        auto& animator = object.addFeature<Animator>(*_assets.getPlayerAsset(),
+                                                     baked ? _assets.getBakedTexturedShader() : _assets.getAnimatedTexturedShader(),
+                                                     &_animatorDrawables, &_opaqueDrawables, SkinOnce,
+                                                     baked ? _bakedAnimation.get() : nullptr);
+        auto& state = animator.getState();
+        for (std::size_t i = 0; !baked && i < state.getSkinCount(); i++) {
+            auto& skin = state.getSkin(i);
+            skin.setJointOffset(_jointMatrices.allocate(UnsignedInt(skin.boneMatrices().size())));
+        }
 
-        for (auto& meshDrawable : animator->meshDrawables()) {
-            meshDrawable->getObject3D().addFeature<ShadowCasterDrawable>(_assets.getAnimatedShadowCasterShader(), _shadowCasterDrawables)
+        auto& shadowCasterShader = baked ? _assets.getBakedShadowCasterShader() : _assets.getAnimatedShadowCasterShader();
+        for (auto& meshDrawable : animator.meshDrawables()) {
+            auto& shadowCaster = meshDrawable->getObject3D().addFeature<ShadowCasterDrawable>(shadowCasterShader, _shadowCasterDrawables)
                     .setMesh(&meshDrawable.get().getMesh())
+                    .setAABB(meshDrawable->getBounds())
                     .setSkinMeshDrawable(meshDrawable.get().getSkinMeshDrawable());
+            addSceneObject(meshDrawable.get(), shadowCaster, true);
         }
+        return animator;
+    }
+
+    void GameState::addSceneObject(TexturedDrawable &drawable, ShadowCasterDrawable &shadowCaster, bool dynamic) {
+        const auto bounds = SceneBvh::transformBounds(drawable.getObject3D().absoluteTransformationMatrix(), drawable.getBounds());
+        arrayAppend(_sceneObjects, InPlaceInit, &drawable, &shadowCaster,
+                    _sceneBvh.insert(bounds, UnsignedInt(_sceneObjects.size())), dynamic);
+    }
+
+    void GameState::refitSceneBvh() {
+        /* Only leaves whose object left their margin change the tree */
+        _sceneBvhRefits = 0;
+        for (auto& object : _sceneObjects) {
+            if (!object.dynamic) continue;
+            const auto bounds = SceneBvh::transformBounds(object.drawable->getObject3D().absoluteTransformationMatrix(), object.drawable->getBounds());
+            if (_sceneBvh.update(object.handle, bounds)) _sceneBvhRefits++;
+        }
+        _sceneBvh.optimize();
+    }
+
+    void GameState::setupPlayer() {
+        RigidBody *rigidBody = &_scene.addChild<RigidBody>(1.0f, &_assets.getPlayerShape(), _physics.getWorld(),
+                                                           RigidBody::CollisionLayer::Dynamic);
+        auto& animationOffset = rigidBody->addChild<Object3D>();
+        Animator *animator = &addAnimator(animationOffset);
 
         animationOffset.setTransformation(Matrix4::translation({0, -0.4f, 0}));
 
-        auto& rb = rigidBody->rigidBody();
-        //Prevent rotation in X & Z
-        rb.setAngularFactor(btVector3(0.0f, 0.0f, 0.0f));
-        rb.setFriction(0.5f);
-        rb.setRollingFriction(0.5f);
+        _player.emplace("Someone", rigidBody, animator);
 
+        auto& rb = rigidBody->rigidBody();
         Debug{} << "Friction: " << rb.getFriction() << "rolling friction" << rb.getRollingFriction();
 
-        _player.emplace("Someone", rigidBody, animator);
         _player->resetToStart(Matrix4::translation({0,2,0}));
         _cameraController->setupTargetFromCurrent(*rigidBody);
 
         animator->play("idle", false);
     }
 
+    void GameState::setupCrowd(UnsignedInt count) {
+        /* Deterministic, so crowd stress runs are comparable */
+        std::mt19937 random{0};
+        std::uniform_real_distribution<Float> unit{0.0f, 1.0f};
+        const Containers::StringView clips[]{"idle", "walk"};
+
+        const auto columns = static_cast<UnsignedInt>(std::ceil(std::sqrt(Float(count))));
+        const Float spacing = 1.0f;
+        for (UnsignedInt i = 0; i < count; i++) {
+            Vector3 position{(Float(i % columns) - 0.5f * Float(columns)) * spacing + 0.5f,
+                             0.0f,
+                             (Float(i / columns) - 0.5f * Float(columns)) * spacing + 0.5f};
+
+            /* Stand on whatever level collision is below, there's no body */
+            btVector3 from{position.x(), 50.0f, position.z()}, to{position.x(), -50.0f, position.z()};
+            btCollisionWorld::ClosestRayResultCallback ground{from, to};
+            _physics.getWorld().rayTest(from, to, ground);
+            if (ground.hasHit()) position.y() = ground.m_hitPointWorld.y();
+
+            auto& object = _scene.addChild<Object3D>();
+            object.setTransformation(Matrix4::translation(position) * Matrix4::rotationY(Rad{unit(random) * Constants::tau()}));
+
+            auto& animator = addAnimator(object, BakedCrowd);
+            animator.setUsesPoseCache(!BakedCrowd);
+            animator.play(clips[i % Containers::arraySize(clips)], true);
+            /* Out of step, so the crowd doesn't move as one */
+            if (auto clip = animator.getState().getClip()) {
+                animator.getState().setTime(unit(random) * clip->getDuration().size());
+            }
+            animator.getState().setSpeed(0.8f + 0.4f * unit(random));
+            arrayAppend(_crowd, animator);
+        }
+
+        Debug{} << "Crowd of" << count << "characters," << (_crowd.isEmpty() ? 0 : _crowd[0]->getState().getByteSize())
+                << "bytes of animation state each";
+    }
+
+    std::string GameState::getCrowdSummary() const {
+        const std::size_t animatorCount = _animatorDrawables.size();
+        std::ostringstream out;
+        out << "Crowd: " << _crowd.size() << "\n"
+            << "Animators: " << animatorCount << ", " << _animatorsUpdated << " updated\n"
+            << "Animation update: " << _animationUpdateMilliseconds << " ms";
+        if (_animatorsUpdated) {
+            out << " (" << _animationUpdateMilliseconds * 1000.0f / Float(_animatorsUpdated) << " us per update)";
+        }
+        auto jobMilliseconds = _animationJobs.getJobMilliseconds();
+        Float slowestJob = 0.0f, jobTotal = 0.0f;
+        for (auto milliseconds : jobMilliseconds) {
+            slowestJob = Math::max(slowestJob, milliseconds);
+            jobTotal += milliseconds;
+        }
+        out << "\nJobs: " << jobMilliseconds.size() << " on " << _animationJobs.getThreadCount() + 1 << " threads, "
+            << jobTotal << " ms total, " << slowestJob << " ms slowest";
+        out << "\nJoint matrices: " << _jointMatrices.getMatrixCount() << ", "
+            << _jointMatrices.getUploadedByteCount() / 1024 << " KB uploaded";
+        if (SkinOnce) out << "\nVertices skinned once: " << _verticesSkinned;
+        const UnsignedInt poseLookups = _poseCache.getFrameHits() + _poseCache.getFrameMisses();
+        out << "\nPose cache: " << _poseCache.getFrameHits() << " of " << poseLookups << " hits";
+        if (poseLookups) out << " (" << 100.0f * Float(_poseCache.getFrameHits()) / Float(poseLookups) << "%)";
+        out << ", " << _poseCache.getEntryCount() << " poses, "
+            << _poseCache.getMatrixCount() * sizeof(Matrix4) / 1024 << " KB";
+        if (_bakedAnimation) {
+            out << "\nBaked: " << _bakedAnimation->getClipCount() << " clips, "
+                << _bakedAnimation->getByteSize() / 1024 << " KB";
+        }
+        for (std::size_t level = 0; level < AnimationLodLevelCount; level++) {
+            out << "\nLOD " << AnimationLod::getName(AnimationLodLevel(level)) << ": " << _animationLodCounts[level];
+        }
+        if (!_crowd.isEmpty()) {
+            auto& animator = *_crowd[0];
+            /* Own objects and drawables of the mesh nodes, the meshes,
+               textures, skeleton and clips are all shared */
+            auto meshBytes = animator.meshDrawables().size()
+                * (sizeof(Object3D) + sizeof(TexturedDrawable) + sizeof(ShadowCasterDrawable));
+            out << "\nAnimation state: " << animator.getState().getByteSize() << " bytes each"
+                << "\nScene objects: " << sizeof(Animator) + meshBytes << " bytes each";
+        }
+        return out.str();
+    }
+
+    std::string GameState::getRenderSummary() const {
+        std::ostringstream out;
+        out << "Opaque\n" << _opaqueQueue.getSummary()
+            << "\nTransparent: " << _transparentQueue.getLastState().draws << " draws, "
+            << _transparentQueue.getLastState().culled << " culled";
+        if (_shadowLight) {
+            out << "\nShadows: " << _shadowLight->getDrawnCount() << " draws, "
+                << _shadowLight->getCulledCount() << " culled in " << _shadowLight->getNumLayers() << " cascades";
+        }
+        out << "\nScene BVH: " << (_useSceneBvh ? "" : "off, ") << _sceneBvh.getLeafCount() << " leaves, "
+            << _sceneBvhRefits << " refit";
+        return out.str();
+    }
+
     void GameState::renderDebug(const Matrix4 &transformationProjectionMatrix) {
         _debugDraw.setTransformationProjectionMatrix(transformationProjectionMatrix);
-        _bWorld.debugDrawWorld();
+        _physics.getWorld().debugDrawWorld();
 
         if (!_debugDrawables.isEmpty()) {
             _cameraController->draw(_debugDrawables);
@@ -274,19 +384,95 @@ namespace MagnumGame {
     }
 
     void GameState::update() {
-        if (_player) _player->update(_timeline.previousFrameDuration());
+        _physics.advance(_timeline.previousFrameDuration(), [&](Float tickDuration) {
+            if (_player) _player->update(tickDuration);
+        });
 
-        _bWorld.stepSimulation(_timeline.previousFrameDuration(), 5);
+        _physics.interpolateDynamicBodies(_physics.getTickInterpolation());
 
         if (_cameraController) {
             _cameraController->update(_timeline.previousFrameDuration());
         }
 
-        //Doesn't actually draw, but updates the bone matrices
-        _cameraController->draw(_animatorDrawables);
+        /* Updates the bone matrices, as often as the distance to the camera
+           and the size on screen call for */
+        auto animationStart = std::chrono::steady_clock::now();
+        const Float frameDuration = _timeline.previousFrameDuration();
+        const AnimationLod lod{_cameraController->getCameraMatrix(), _cameraController->getProjectionMatrix()};
+        std::fill(std::begin(_animationLodCounts), std::end(_animationLodCounts), 0u);
+        arrayResize(_animatorsToUpdate, NoInit, 0);
+        _poseCache.resetFrameCounts();
+        const auto allocateJoints = [&](UnsignedInt count) { return _jointMatrices.allocate(count); };
+        for (std::size_t i = 0; i < _animatorDrawables.size(); i++) {
+            auto& animator = static_cast<Animator&>(_animatorDrawables[i]);
+            _animationLodCounts[std::size_t(animator.prepareUpdate(frameDuration, lod, _animationFrameIndex))]++;
+            if (!animator.needsPoseUpdate()) continue;
+
+            /* Only the first character at a step of a clip samples it, the
+               others show the same matrices */
+            if (animator.usesPoseCache() && PoseCache::StepsPerSecond > 0.0f && animator.getState().getClip()) {
+                auto cached = _poseCache.lookup(animator.getState(), allocateJoints);
+                if (cached.hit) {
+                    animator.showCachedPose(cached.jointOffsets);
+                    continue;
+                }
+                if (cached.jointOffsets.isEmpty()) animator.useOwnPose();
+                else animator.fillCachedPose(cached.time, cached.jointOffsets);
+            }
+            arrayAppend(_animatorsToUpdate, &animator);
+        }
+        _animationFrameIndex++;
+        _animatorsUpdated = UnsignedInt(_animatorsToUpdate.size());
+
+        /* Each job only writes the poses and Skin matrices of its own
+           animators, run() returns once all are done so they're ready to
+           render */
+        const auto perJob = UnsignedInt(Math::max(AnimationState::UpdatesPerJob, 1));
+        const auto jobCount = (_animatorsUpdated + perJob - 1) / perJob;
+        _animationJobs.run(jobCount, [&](UnsignedInt job) {
+            const auto end = Math::min((job + 1) * perJob, _animatorsUpdated);
+            for (auto i = job * perJob; i < end; i++) _animatorsToUpdate[i]->updatePose();
+        });
+
+        /* One upload for the shadow and main passes of every character */
+        for (auto* animator : _animatorsToUpdate) {
+            auto& state = animator->getState();
+            for (std::size_t i = 0; i < state.getSkinCount(); i++) {
+                auto& skin = state.getSkin(i);
+                _jointMatrices.write(skin.getJointOffset(), skin.boneMatrices());
+            }
+        }
+        _jointMatrices.upload();
+        if (_bakedAnimation) _bakedAnimation->bind();
+
+        /* Skin the characters that moved once for the shadow and main
+           passes, the others keep last frame's vertices */
+        _verticesSkinned = 0;
+        if (SkinOnce) {
+            GL::Renderer::enable(GL::Renderer::Feature::RasterizerDiscard);
+            for (std::size_t i = 0; i < _animatorDrawables.size(); i++) {
+                _verticesSkinned += static_cast<Animator&>(_animatorDrawables[i]).skinMeshes(_assets.getSkinningShader(), _skinningFeedback);
+            }
+            GL::Renderer::disable(GL::Renderer::Feature::RasterizerDiscard);
+        }
+        std::chrono::duration<Float, std::milli> animationDuration = std::chrono::steady_clock::now() - animationStart;
+        _animationUpdateMilliseconds = animationDuration.count();
     }
 
 
+    void GameState::saveSnapshot(PhysicsSnapshot &snapshot) const {
+        _physics.saveSnapshot(snapshot);
+        resizeSnapshotArray(snapshot.players, _player ? 1 : 0);
+        if (_player) _player->saveState(snapshot.players[0]);
+    }
+
+    bool GameState::restoreSnapshot(const PhysicsSnapshot &snapshot) {
+        if (snapshot.players.size() != (_player ? 1u : 0u)) return false;
+        if (!_physics.restoreSnapshot(snapshot)) return false;
+        if (_player) _player->restoreState(snapshot.players[0]);
+        return true;
+    }
+
     void GameState::addDebugDrawable(SceneGraph::AbstractObject3D &playerRigidBody) {
         //This is a feature added to playerRigidBody - it is deleted with that. Not nice to allocate in app code and delete in library code.
         new DebugTools::ObjectRenderer3D{
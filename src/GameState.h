@@ -1,12 +1,26 @@
 #pragma once
 #include <BulletCollision/CollisionDispatch/btGhostObject.h>
 #include <BulletCollision/CollisionShapes/btSphereShape.h>
+#include <string>
+#include <Corrade/Containers/Reference.h>
 #include <Magnum/BulletIntegration/DebugDraw.h>
+#include <Magnum/GL/TransformFeedback.h>
 
+#include "AnimationLod.h"
+#include "BakedAnimation.h"
+#include "FrameUniforms.h"
 #include "GameAssets.h"
+#include "JobPool.h"
+#include "JointMatrixTexture.h"
+#include "LevelCollision.h"
 #include "MagnumGameApp.h"
+#include "PhysicsWorld.h"
+#include "PoseCache.h"
+#include "RenderQueue.h"
+#include "SceneBvh.h"
 
 namespace MagnumGame {
+    class ShadowCasterDrawable;
     class ShadowLight;
 }
 
@@ -17,6 +31,20 @@ namespace MagnumGame {
 
     class GameState {
     public:
+        /* Worker threads for animation updates besides the main one, -1 for
+           one less than the hardware threads. Read on construction */
+        inline static Int AnimationThreadCount = -1;
+        /* Skin characters once a frame into a buffer the shadow and main
+           passes share instead of in both of their vertex shaders. Read
+           when characters are added */
+        inline static bool SkinOnce = true;
+        /* Crowd characters play clips baked into a texture, posed on the GPU
+           without any per-frame CPU animation work */
+        inline static bool BakedCrowd = false;
+        /* Opaque and shadow passes query the SceneBvh for what to draw
+           instead of testing every drawable. Read on construction */
+        inline static bool UseSceneBvh = true;
+
         explicit GameState(const Timeline& timeline, GameAssets& assets);
         ~GameState();
 
@@ -25,9 +53,18 @@ namespace MagnumGame {
 
         void setupPlayer();
 
+        /* Spawns @p count animated characters without physics around the
+           start, sharing the player's AnimatorAsset */
+        void setupCrowd(UnsignedInt count);
+
+        std::string getCrowdSummary() const;
+
+        /* Draw, state change and culling counts of the last frame */
+        std::string getRenderSummary() const;
+
         Player* getPlayer() { return _player.get(); }
 
-        btCollisionWorld& getWorld() { return _bWorld; }
+        btCollisionWorld& getWorld() { return _physics.getWorld(); }
 
         void renderDebug(const Matrix4& matrix4);
 
@@ -43,40 +80,83 @@ namespace MagnumGame {
 
         void drawShadowBuffer();
 
+        UnsignedLong getTickCount() const { return _physics.getTickCount(); }
+
+        const PhysicsProfiler& getPhysicsProfiler() const { return _physics.getProfiler(); }
+
+        /* Saves the world and player into a reusable snapshot, see PhysicsSnapshot */
+        void saveSnapshot(PhysicsSnapshot& snapshot) const;
+        bool restoreSnapshot(const PhysicsSnapshot& snapshot);
+
     private:
         const Timeline& _timeline;
         GameAssets& _assets;
 
-        btDbvtBroadphase _bBroadphase;
-        btDefaultCollisionConfiguration _bCollisionConfig;
-        btCollisionDispatcher _bDispatcher{&_bCollisionConfig};
-        btSequentialImpulseConstraintSolver _bSolver;
         BulletIntegration::DebugDraw _debugDraw{NoCreate};
 
         /* The world has to live longer than the scene because RigidBody
            instances have to remove themselves from it on destruction */
-        btDiscreteDynamicsWorld _bWorld{&_bDispatcher, &_bBroadphase, &_bSolver, &_bCollisionConfig};
+        PhysicsWorld _physics;
+        LevelCollision _levelCollision{_physics.getConfiguration().levelCollision};
 
         Containers::Array<Containers::Pointer<GL::Mesh>> _levelMeshes{};
-        Containers::Array<Containers::Pointer<btConvexHullShape>> _levelShapes{};
+        /* Local bounds of each level mesh, for culling */
+        Containers::Array<Range3D> _levelMeshBounds{};
         Containers::Array<GL::Texture2D> _levelTextures{};
         Containers::Array<MaterialAsset> _levelMaterials{};
-        std::map<GL::Mesh*, btConvexHullShape*> _meshToShapeMap{};
 
         DebugTools::ResourceManager _debugResourceManager{};
 
         SceneGraph::DrawableGroup3D _debugDrawables{};
         SceneGraph::DrawableGroup3D _animatorDrawables{};
+        /* Only TexturedDrawable instances, drawn through _opaqueQueue */
         SceneGraph::DrawableGroup3D _opaqueDrawables{};
+        /* Only TexturedDrawable instances too */
         SceneGraph::DrawableGroup3D _transparentDrawables{};
 
         SceneGraph::DrawableGroup3D _shadowCasterDrawables{};
 
+        /* An opaque drawable and the shadow caster of the same object,
+           with one leaf in _sceneBvh for both */
+        struct SceneObject {
+            TexturedDrawable* drawable;
+            ShadowCasterDrawable* shadowCaster;
+            SceneBvh::Handle handle;
+            /* Refit every frame, level objects never move */
+            bool dynamic;
+        };
+        Containers::Array<SceneObject> _sceneObjects;
+        SceneBvh _sceneBvh;
+        bool _useSceneBvh{UseSceneBvh};
+        UnsignedInt _sceneBvhRefits{};
+        /* Results of the last query */
+        Containers::Array<UnsignedInt> _queryIds;
+        Containers::Array<TexturedDrawable*> _queryDrawables;
+        Containers::Array<ShadowCasterDrawable*> _queryShadowCasters;
+
+        RenderQueue _opaqueQueue;
+        RenderQueue _transparentQueue{RenderOrder::BackToFront};
+        /* View 0 is the camera, the shadow cascades follow */
+        FrameUniforms _frameUniforms{1 + GameAssets::ShadowMapLevels};
+
         Scene3D _scene{};
         Containers::Pointer<CameraController> _cameraController;
 
         Containers::Pointer<Player> _player;
 
+        Containers::Array<Containers::Reference<Animator>> _crowd;
+        Float _animationUpdateMilliseconds{};
+        UnsignedLong _animationFrameIndex{};
+        UnsignedInt _animationLodCounts[AnimationLodLevelCount]{};
+        UnsignedInt _animatorsUpdated{};
+        Containers::Array<Animator*> _animatorsToUpdate;
+        JobPool _animationJobs{AnimationThreadCount};
+        JointMatrixTexture _jointMatrices;
+        PoseCache _poseCache;
+        GL::TransformFeedback _skinningFeedback;
+        Containers::Pointer<BakedAnimation> _bakedAnimation;
+        UnsignedInt _verticesSkinned{};
+
         Containers::Pointer<ShadowLight> _shadowLight;
 
         bool _isStarted = false;
@@ -85,5 +165,12 @@ namespace MagnumGame {
         btGhostObject _bSphereQueryObject;
 
         void addDebugDrawable(SceneGraph::AbstractObject3D &playerRigidBody);
+
+        Animator& addAnimator(Object3D& object, bool baked = false);
+
+        void addSceneObject(TexturedDrawable& drawable, ShadowCasterDrawable& shadowCaster, bool dynamic);
+
+        /* Moves the leaves of dynamic objects to where they are now */
+        void refitSceneBvh();
     };
 }
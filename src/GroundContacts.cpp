@@ -0,0 +1,51 @@
+#include "GroundContacts.h"
+
+#include "RigidBody.h"
+
+namespace MagnumGame {
+
+    void GroundContacts::update(btCollisionWorld& world) {
+        auto& collisionObjects = world.getCollisionObjectArray();
+        for (int i = 0; i < collisionObjects.size(); i++) {
+            auto collisionObject = collisionObjects[i];
+            if (collisionObject->isStaticOrKinematicObject()) continue;
+            if (auto rigidBody = RigidBody::fromCollisionObject(collisionObject)) {
+                rigidBody->setOnGround(false);
+            }
+        }
+
+        _groundedCount = 0;
+        auto dispatcher = world.getDispatcher();
+        for (int i = 0; i < dispatcher->getNumManifolds(); i++) {
+            auto manifold = dispatcher->getManifoldByIndexInternal(i);
+            if (manifold->getNumContacts() == 0) continue;
+
+            auto body0 = manifold->getBody0();
+            auto body1 = manifold->getBody1();
+            markGrounded(body0, body1, *manifold, true);
+            markGrounded(body1, body0, *manifold, false);
+        }
+    }
+
+    void GroundContacts::markGrounded(const btCollisionObject* body, const btCollisionObject* other,
+                                      const btPersistentManifold& manifold, bool isBody0) {
+        if (body->isStaticOrKinematicObject() || !other->isStaticObject()) return;
+
+        auto rigidBody = RigidBody::fromCollisionObject(body);
+        if (!rigidBody || rigidBody->isOnGround()) return;
+
+        for (int p = 0; p < manifold.getNumContacts(); p++) {
+            auto& point = manifold.getContactPoint(p);
+            /* Manifolds keep separated points until they pass the contact
+               breaking threshold, only touching ones count, as with
+               contactTest() */
+            if (point.getDistance() > 0.0f) continue;
+            auto& localPoint = isBody0 ? point.m_localPointA : point.m_localPointB;
+            if (localPoint.y() < 0.0f) {
+                rigidBody->setOnGround(true);
+                _groundedCount++;
+                return;
+            }
+        }
+    }
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <btBulletDynamicsCommon.h>
+
+#include "MagnumGameCommon.h"
+
+namespace MagnumGame {
+
+    /**
+     * @brief On-ground state of all dynamic bodies in one pass per tick
+     *
+     * Reads the contact manifolds the simulation step already left in the
+     * dispatcher instead of running another narrowphase query per character.
+     * A body is on the ground if it touches a static object below its origin.
+     */
+    class GroundContacts {
+    public:
+        /* Call after every simulation step, sets RigidBody::isOnGround() */
+        void update(btCollisionWorld& world);
+
+        UnsignedInt getGroundedCount() const { return _groundedCount; }
+
+    private:
+        void markGrounded(const btCollisionObject* body, const btCollisionObject* other,
+                          const btPersistentManifold& manifold, bool isBody0);
+
+        UnsignedInt _groundedCount{};
+    };
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include <Corrade/Containers/StringView.h>
+
+namespace MagnumGame {
+
+    /**
+     * @brief Interface for objects that can play named animations
+     *
+     * Keeps game logic such as Player independent of the skinned mesh
+     * rendering, so it also runs in the headless simulation.
+     */
+    class IAnimatable {
+    public:
+        virtual void play(const Corrade::Containers::StringView& animationName, bool restart) = 0;
+    protected:
+        ~IAnimatable() = default;
+
+    };
+}
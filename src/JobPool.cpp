@@ -0,0 +1,90 @@
+#include "JobPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <Corrade/configure.h>
+
+namespace MagnumGame {
+
+    JobPool::JobPool(Int threadCount) {
+#if defined(CORRADE_TARGET_EMSCRIPTEN) && !defined(__EMSCRIPTEN_PTHREADS__)
+        threadCount = 0;
+#else
+        if (threadCount < 0) threadCount = Int(std::max(std::thread::hardware_concurrency(), 1u)) - 1;
+#endif
+        _threads = Containers::Array<std::thread>{std::size_t(threadCount)};
+        for (auto& thread : _threads) thread = std::thread{&JobPool::workerLoop, this};
+    }
+
+    JobPool::~JobPool() {
+        {
+            std::lock_guard<std::mutex> lock{_mutex};
+            _quit = true;
+        }
+        _workAvailable.notify_all();
+        for (auto& thread : _threads) thread.join();
+    }
+
+    void JobPool::run(UnsignedInt jobCount, const std::function<void(UnsignedInt)> &job) {
+        _lastJobCount = jobCount;
+        if (!jobCount) return;
+        if (_jobMilliseconds.size() < jobCount) _jobMilliseconds = Containers::Array<Float>{ValueInit, jobCount};
+
+        if (_threads.isEmpty() || jobCount == 1) {
+            _job = &job;
+            _jobCount = jobCount;
+            _nextJob.store(0, std::memory_order_relaxed);
+            runJobs();
+            _job = nullptr;
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock{_mutex};
+            _job = &job;
+            _jobCount = jobCount;
+            _nextJob.store(0, std::memory_order_relaxed);
+            /* Every worker takes part in every run, even if there's nothing
+               left for it by the time it wakes up, so none of them can still
+               be looking at the job once this returns */
+            _busyWorkers = UnsignedInt(_threads.size());
+            _generation++;
+        }
+        _workAvailable.notify_all();
+
+        runJobs();
+
+        std::unique_lock<std::mutex> lock{_mutex};
+        _workDone.wait(lock, [&] { return _busyWorkers == 0; });
+        _job = nullptr;
+    }
+
+    void JobPool::workerLoop() {
+        UnsignedLong seenGeneration = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock{_mutex};
+                _workAvailable.wait(lock, [&] { return _quit || _generation != seenGeneration; });
+                if (_quit) return;
+                seenGeneration = _generation;
+            }
+
+            runJobs();
+
+            std::lock_guard<std::mutex> lock{_mutex};
+            if (--_busyWorkers == 0) _workDone.notify_one();
+        }
+    }
+
+    void JobPool::runJobs() {
+        for (;;) {
+            auto index = _nextJob.fetch_add(1, std::memory_order_relaxed);
+            if (index >= _jobCount) return;
+
+            auto start = std::chrono::steady_clock::now();
+            (*_job)(index);
+            std::chrono::duration<Float, std::milli> duration = std::chrono::steady_clock::now() - start;
+            _jobMilliseconds[index] = duration.count();
+        }
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <Corrade/Containers/Array.h>
+
+#include "MagnumGameCommon.h"
+
+namespace MagnumGame {
+
+    /**
+     * @brief Fixed set of worker threads running indexed jobs
+     *
+     * run() hands out job indices to the workers and the calling thread
+     * until all are taken, and returns once every job has finished, so the
+     * caller can use the results right away. Jobs must only write to data
+     * no other job of the same run touches. Without threads (on the web, or
+     * with a thread count of 0) the jobs run one after another on the
+     * calling thread. Holds no GL state.
+     */
+    class JobPool {
+    public:
+        /* Threads besides the calling one, -1 for one less than the
+           hardware threads */
+        explicit JobPool(Int threadCount);
+        ~JobPool();
+
+        DISALLOW_COPY(JobPool)
+
+        void run(UnsignedInt jobCount, const std::function<void(UnsignedInt)>& job);
+
+        UnsignedInt getThreadCount() const { return UnsignedInt(_threads.size()); }
+
+        /* Wall time of every job of the last run() */
+        Containers::ArrayView<const Float> getJobMilliseconds() const { return {_jobMilliseconds.data(), _lastJobCount}; }
+
+    private:
+        void workerLoop();
+        void runJobs();
+
+        Containers::Array<std::thread> _threads;
+        std::mutex _mutex;
+        std::condition_variable _workAvailable;
+        std::condition_variable _workDone;
+
+        /* Guarded by _mutex */
+        UnsignedLong _generation{};
+        UnsignedInt _busyWorkers{};
+        bool _quit{};
+
+        const std::function<void(UnsignedInt)>* _job{};
+        UnsignedInt _jobCount{};
+        std::atomic<UnsignedInt> _nextJob{};
+
+        Containers::Array<Float> _jobMilliseconds;
+        UnsignedInt _lastJobCount{};
+    };
+}
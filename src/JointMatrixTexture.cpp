@@ -0,0 +1,65 @@
+#include "JointMatrixTexture.h"
+
+#include <Corrade/Containers/GrowableArray.h>
+#include <Corrade/Utility/Algorithms.h>
+#include <Magnum/ImageView.h>
+#include <Magnum/PixelFormat.h>
+#include <Magnum/GL/TextureFormat.h>
+#include <Magnum/Math/Functions.h>
+
+namespace MagnumGame {
+
+    UnsignedInt JointMatrixTexture::allocate(UnsignedInt count) {
+        const UnsignedInt offset = _matrixCount;
+        _matrixCount += count;
+
+        /* Grow in powers of two rows so adding a crowd doesn't recreate the
+           texture for every character */
+        if (_matrixCount > _matrices.size()) {
+            std::size_t rows = Math::max<std::size_t>(_matrices.size() / MatricesPerRow, 1);
+            while (rows * MatricesPerRow < _matrixCount) rows *= 2;
+            arrayResize(_matrices, ValueInit, rows * MatricesPerRow);
+        }
+
+        _dirtyBegin = Math::min(_dirtyBegin, offset);
+        _dirtyEnd = Math::max(_dirtyEnd, _matrixCount);
+        return offset;
+    }
+
+    void JointMatrixTexture::write(UnsignedInt offset, Containers::ArrayView<const Matrix4> matrices) {
+        CORRADE_INTERNAL_ASSERT(offset + matrices.size() <= _matrixCount);
+        Utility::copy(matrices, _matrices.sliceSize(offset, matrices.size()));
+        _dirtyBegin = Math::min(_dirtyBegin, offset);
+        _dirtyEnd = Math::max(_dirtyEnd, UnsignedInt(offset + matrices.size()));
+    }
+
+    void JointMatrixTexture::upload() {
+        _uploadedByteCount = 0;
+        if (!_matrixCount) return;
+
+        const Int rows = Int(_matrices.size() / MatricesPerRow);
+        if (rows > _textureRows) {
+            _texture = GL::Texture2D{};
+            _texture.setMinificationFilter(GL::SamplerFilter::Nearest)
+                    .setMagnificationFilter(GL::SamplerFilter::Nearest)
+                    .setWrapping(GL::SamplerWrapping::ClampToEdge)
+                    .setStorage(1, GL::TextureFormat::RGBA32F, {MatricesPerRow * 4, rows});
+            _textureRows = rows;
+            _dirtyBegin = 0;
+            _dirtyEnd = _matrixCount;
+        }
+
+        if (_dirtyBegin < _dirtyEnd) {
+            const Int firstRow = Int(_dirtyBegin / MatricesPerRow);
+            const Int endRow = Int((_dirtyEnd + MatricesPerRow - 1) / MatricesPerRow);
+            auto data = _matrices.slice(std::size_t(firstRow) * MatricesPerRow, std::size_t(endRow) * MatricesPerRow);
+            _texture.setSubImage(0, {0, firstRow}, ImageView2D{PixelFormat::RGBA32F, {MatricesPerRow * 4, endRow - firstRow}, data});
+            _uploadedByteCount = data.size() * sizeof(Matrix4);
+            _dirtyBegin = ~0u;
+            _dirtyEnd = 0;
+        }
+
+        _texture.bind(TextureUnit);
+        CHECK_GL_ERROR();
+    }
+}
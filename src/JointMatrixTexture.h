@@ -0,0 +1,58 @@
+#pragma once
+
+#include <Corrade/Containers/Array.h>
+#include <Magnum/GL/Texture.h>
+#include <Magnum/Math/Matrix4.h>
+
+#include "MagnumGameCommon.h"
+
+namespace MagnumGame {
+
+    /**
+     * @brief Joint matrices of every skinned character in one float texture
+     *
+     * Every Skin gets a fixed range of matrices when its character is added.
+     * The updated ones are written here after the animation update and the
+     * texture is uploaded once a frame, the draws in the shadow and main
+     * passes only set the offset of their skin. A matrix is four RGBA32F
+     * texels, its columns, MatricesPerRow to a row, read with texelFetch()
+     * so it works on WebGL 2 without buffer textures.
+     */
+    class JointMatrixTexture {
+    public:
+        static constexpr Int MatricesPerRow = 256;
+        /* Left bound between draws, no other texture uses it */
+        static constexpr Int TextureUnit = 2;
+
+        explicit JointMatrixTexture() = default;
+
+        DISALLOW_COPY(JointMatrixTexture)
+
+        /* Reserves @p count consecutive matrices, set to identity, and
+           returns the first */
+        UnsignedInt allocate(UnsignedInt count);
+
+        /* Copies @p matrices to @p offset, uploaded by the next upload() */
+        void write(UnsignedInt offset, Containers::ArrayView<const Matrix4> matrices);
+
+        /* Uploads the rows written since the last call and binds the
+           texture, once a frame before drawing */
+        void upload();
+
+        UnsignedInt getMatrixCount() const { return _matrixCount; }
+
+        /* Bytes sent by the last upload() */
+        std::size_t getUploadedByteCount() const { return _uploadedByteCount; }
+
+    private:
+        /* Whole rows, as many as the texture has */
+        Containers::Array<Matrix4> _matrices;
+        UnsignedInt _matrixCount{};
+        GL::Texture2D _texture{NoCreate};
+        Int _textureRows{};
+        /* Matrices written since the last upload */
+        UnsignedInt _dirtyBegin{~0u};
+        UnsignedInt _dirtyEnd{};
+        std::size_t _uploadedByteCount{};
+    };
+}
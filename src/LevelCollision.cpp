@@ -0,0 +1,364 @@
+#include "LevelCollision.h"
+
+#include <algorithm>
+#include <cstring>
+#include <BulletCollision/CollisionShapes/btOptimizedBvh.h>
+#include <Corrade/Containers/GrowableArray.h>
+#include <Corrade/Containers/Optional.h>
+#include <Corrade/Containers/Pair.h>
+#include <Corrade/Containers/String.h>
+#include <Corrade/Containers/StructuredBindings.h>
+#include <Corrade/Utility/Assert.h>
+#include <Corrade/Utility/Debug.h>
+#include <Corrade/Utility/Path.h>
+#include <Corrade/Utility/String.h>
+#include <Magnum/BulletIntegration/Integration.h>
+#include <Magnum/Math/FunctionsBatch.h>
+#include <Magnum/Math/Matrix4.h>
+#include <Magnum/SceneGraph/Scene.h>
+#include <Magnum/Trade/AbstractImporter.h>
+#include <Magnum/Trade/MeshData.h>
+#include <Magnum/Trade/SceneData.h>
+
+#include "ConvexDecomposition.h"
+#include "RigidBody.h"
+
+namespace MagnumGame {
+
+    namespace {
+        struct BvhCacheHeader {
+            char magic[4];
+            UnsignedInt version;
+            UnsignedLong hash;
+            UnsignedInt vertexCount;
+            UnsignedInt triangleCount;
+            UnsignedInt bvhSize;
+            UnsignedInt padding;
+        };
+
+        constexpr char BvhCacheMagic[4]{'M', 'G', 'B', 'V'};
+        /* Bump when the layout of the cache or of the merged triangles changes */
+        constexpr UnsignedInt BvhCacheVersion = 1;
+
+        /* FNV-1a */
+        void hashBytes(UnsignedLong& hash, const void* data, std::size_t size) {
+            auto bytes = static_cast<const unsigned char*>(data);
+            for (std::size_t i = 0; i < size; i++) {
+                hash ^= bytes[i];
+                hash *= 0x100000001b3ull;
+            }
+        }
+
+        Containers::Array<char> allocateBvhBuffer(std::size_t size) {
+            /* btQuantizedBvh serializes and deserializes in place into 16-byte aligned memory */
+            return Containers::Array<char>{static_cast<char*>(btAlignedAlloc(size, 16)), size,
+                                           [](char* data, std::size_t) { btAlignedFree(data); }};
+        }
+    }
+
+    LevelCollision::~LevelCollision() = default;
+
+    bool LevelCollision::isColliderName(Containers::StringView name) {
+        return name.hasSuffix(ColliderSuffix);
+    }
+
+    PrimitiveCollider LevelCollision::primitiveColliderForName(Containers::StringView objectName) {
+        auto name = objectName;
+        auto dot = name.findLast('.');
+        if (dot.data()) {
+            auto number = name.exceptPrefix(std::size_t(dot.end() - name.begin()));
+            if (!number.isEmpty() && std::all_of(number.begin(), number.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+                name = name.prefix(dot.begin());
+            }
+        }
+
+        if (name.hasSuffix(BoxSuffix)) return PrimitiveCollider::Box;
+        if (name.hasSuffix(SphereSuffix)) return PrimitiveCollider::Sphere;
+        if (name.hasSuffix(CapsuleSuffix)) return PrimitiveCollider::Capsule;
+        return PrimitiveCollider::None;
+    }
+
+    void LevelCollision::loadShapes(Trade::AbstractImporter &importer,
+                                    const std::function<void(UnsignedInt, const Trade::MeshData &)> &onRenderMesh) {
+        arrayRemove(_shapes, 0, _shapes.size());
+        arrayReserve(_shapes, importer.meshCount());
+        _meshShapes = Containers::Array<btCollisionShape*>{ValueInit, importer.meshCount()};
+        _meshBounds = Containers::Array<Range3D>{ValueInit, importer.meshCount()};
+        _meshTriangles = Containers::Array<MeshTriangles>{importer.meshCount()};
+        _meshColliders = Containers::Array<Int>{NoInit, importer.meshCount()};
+
+        for (auto meshId = 0U; meshId < importer.meshCount(); meshId++) {
+            _meshColliders[meshId] = meshId;
+        }
+
+        Debug{} << "Meshes:" << importer.meshCount();
+        for (auto meshId = 0U; meshId < importer.meshCount(); meshId++) {
+            auto meshName = importer.meshName(meshId);
+            Debug debug{};
+            debug << "\tMesh" << meshId << ":" << meshName;
+            auto meshData = importer.mesh(meshId);
+            if (!meshData) continue;
+
+            auto addCollisionMesh = [&] {
+                MeshTriangles triangles;
+                triangles.positions = meshData->positions3DAsArray();
+                if (!triangles.positions.isEmpty()) {
+                    _meshBounds[meshId] = Range3D{Math::minmax(triangles.positions)};
+                }
+                if (meshData->primitive() != MeshPrimitive::Triangles) {
+                    /* No triangles to decompose, all points go in a single hull */
+                    if (_mode == LevelCollisionMode::MergedBvh) {
+                        Warning{} << "Mesh" << meshId << meshName << "isn't triangles, it won't collide";
+                        return;
+                    }
+                } else if (meshData->isIndexed()) {
+                    triangles.indices = meshData->indicesAsArray();
+                } else {
+                    triangles.indices = Containers::Array<UnsignedInt>{NoInit, triangles.positions.size()};
+                    for (UnsignedInt i = 0; i < triangles.indices.size(); i++) {
+                        triangles.indices[i] = i;
+                    }
+                }
+
+                if (_mode == LevelCollisionMode::MergedBvh) {
+                    _meshTriangles[meshId] = std::move(triangles);
+                } else {
+                    ConvexDecomposition decomposition{triangles.positions, triangles.indices};
+                    _meshShapes[meshId] = addHullShapes(decomposition.getHulls());
+                    debug << "decomposed into" << decomposition.getHulls().size() << "hulls with"
+                          << decomposition.getOutputVertexCount() << "vertices, saving"
+                          << Int(decomposition.getInputVertexCount()) - Int(decomposition.getOutputVertexCount()) << "of"
+                          << decomposition.getInputVertexCount();
+                }
+            };
+
+            if (isColliderName(meshName)) {
+                auto normalMeshName = Utility::String::stripSuffix(meshName, ColliderSuffix);
+                auto normalMeshId = importer.meshForName(normalMeshName);
+                if (normalMeshId != -1) {
+                    debug << "is a collider for" << normalMeshId << normalMeshName;
+                    _meshColliders[normalMeshId] = meshId;
+                } else {
+                    debug << "is a standalone collider";
+                }
+                addCollisionMesh();
+            } else {
+                auto colliderName = meshName + ColliderSuffix;
+                auto colliderId = importer.meshForName(colliderName);
+                if (colliderId != -1) {
+                    _meshColliders[meshId] = colliderId;
+                    debug << "has a collider" << colliderId << colliderName;
+                } else {
+                    debug << "has no explicit collider, creating from mesh";
+                    addCollisionMesh();
+                }
+                if (onRenderMesh) onRenderMesh(meshId, *meshData);
+            }
+        }
+
+        for (auto meshId = 0U; meshId < importer.meshCount(); meshId++) {
+            auto shapeId = _meshColliders[meshId];
+            _meshShapes[meshId] = _meshShapes[shapeId];
+            Debug{} << "Mesh" << meshId << importer.meshName(meshId) << "has shape" << shapeId << importer.meshName(shapeId);
+        }
+    }
+
+    btCollisionShape* LevelCollision::addHullShapes(const Containers::Array<Containers::Array<Vector3>>& hulls) {
+        if (hulls.isEmpty()) return nullptr;
+
+        auto addHull = [&](const Containers::Array<Vector3>& hull) {
+            return arrayAppend(_shapes, Containers::Pointer<btCollisionShape>{
+                new btConvexHullShape{hull.data()->data(), static_cast<int>(hull.size()), sizeof(Vector3)}
+            }).get();
+        };
+
+        /* Not worth going through a compound for an already convex mesh */
+        if (hulls.size() == 1) return addHull(hulls[0]);
+
+        auto compound = new btCompoundShape{true, static_cast<int>(hulls.size())};
+        for (auto& hull : hulls) {
+            compound->addChildShape(btTransform::getIdentity(), addHull(hull));
+        }
+        return arrayAppend(_shapes, Containers::Pointer<btCollisionShape>{compound}).get();
+    }
+
+    Object3D& LevelCollision::addPrimitiveObject(PrimitiveCollider primitive, const Range3D& bounds, const Matrix4& transformation,
+                                                 Scene3D& scene, btDynamicsWorld& world) {
+        /* Bullet transforms can't scale, so the scale goes into the shape
+           dimensions and the body sits at the center of the bounds */
+        auto halfExtents = bounds.size() * 0.5f * transformation.scaling();
+        auto bodyTransformation = Matrix4::from(transformation.rotation(), transformation.transformPoint(bounds.center()));
+
+        Containers::Pointer<btCollisionShape> shape;
+        switch (primitive) {
+            case PrimitiveCollider::Box:
+                shape.emplace<btBoxShape>(btVector3{halfExtents});
+                break;
+            case PrimitiveCollider::Sphere:
+                shape.emplace<btSphereShape>(halfExtents.max());
+                break;
+            case PrimitiveCollider::Capsule: {
+                /* Along the longest side, as wide as the wider of the others */
+                Int axis = halfExtents.x() >= halfExtents.y() && halfExtents.x() >= halfExtents.z() ? 0 : (halfExtents.y() >= halfExtents.z() ? 1 : 2);
+                Float radius = Math::max(halfExtents[(axis + 1) % 3], halfExtents[(axis + 2) % 3]);
+                Float height = 2.0f * Math::max(halfExtents[axis] - radius, 0.0f);
+                if (axis == 0) shape.emplace<btCapsuleShapeX>(radius, height);
+                else if (axis == 1) shape.emplace<btCapsuleShape>(radius, height);
+                else shape.emplace<btCapsuleShapeZ>(radius, height);
+                break;
+            }
+            case PrimitiveCollider::None:
+                CORRADE_INTERNAL_ASSERT_UNREACHABLE();
+        }
+
+        auto& rigidBody = scene.addChild<RigidBody>(0.0f, arrayAppend(_shapes, std::move(shape)).get(), world, RigidBody::CollisionLayer::Terrain);
+        rigidBody.setTransformation(bodyTransformation);
+        rigidBody.syncPose();
+
+        auto& object = rigidBody.addChild<Object3D>();
+        object.setTransformation(bodyTransformation.inverted() * transformation);
+        return object;
+    }
+
+    void LevelCollision::addObjects(Trade::AbstractImporter &importer, const Trade::SceneData &sceneData,
+                                    Scene3D &scene, btDynamicsWorld &world,
+                                    const std::function<void(Object3D &, UnsignedInt, Int)> &onMeshObject) {
+        for (auto &objectId: sceneData.childrenFor(-1)) {
+            auto objectName = importer.objectName(objectId);
+            if (isColliderName(objectName)) {
+                continue;
+            }
+
+            auto primitive = primitiveColliderForName(objectName);
+            auto matrix = sceneData.transformation3DFor(objectId);
+            auto transformation = matrix ? *matrix : Matrix4{Math::IdentityInit};
+            for (auto &[meshId, materialId]: sceneData.meshesMaterialsFor(objectId)) {
+                Object3D* object;
+
+                if (primitive != PrimitiveCollider::None) {
+                    object = &addPrimitiveObject(primitive, _meshBounds[_meshColliders[meshId]], transformation, scene, world);
+                } else if (_mode == LevelCollisionMode::MergedBvh) {
+                    auto& triangles = _meshTriangles[_meshColliders[meshId]];
+                    auto indexOffset = static_cast<Int>(_mergedPositions.size());
+                    for (auto& position : triangles.positions) {
+                        arrayAppend(_mergedPositions, transformation.transformPoint(position));
+                    }
+                    for (auto index : triangles.indices) {
+                        arrayAppend(_mergedIndices, indexOffset + static_cast<Int>(index));
+                    }
+
+                    object = &scene.addChild<Object3D>();
+                    object->setTransformation(transformation);
+                } else {
+                    auto shape = _meshShapes[meshId];
+                    if (!shape) {
+                        Warning{} << "No collision shape for mesh" << meshId << importer.meshName(meshId);
+                        continue;
+                    }
+                    auto &rigidBody = scene.addChild<RigidBody>(0.0f, shape, world, RigidBody::CollisionLayer::Terrain);
+
+                    rigidBody.setTransformation(transformation);
+                    rigidBody.syncPose();
+                    object = &rigidBody;
+                }
+
+                if (onMeshObject) onMeshObject(*object, meshId, materialId);
+            }
+        }
+    }
+
+    void LevelCollision::finish(Scene3D &scene, btDynamicsWorld &world, Containers::StringView levelFilePath) {
+        if (_mode != LevelCollisionMode::MergedBvh) return;
+
+        if (_mergedIndices.isEmpty()) {
+            Warning{} << "No level triangles to collide with";
+            return;
+        }
+
+        _mergedMesh.emplace(static_cast<int>(_mergedIndices.size() / 3), _mergedIndices.data(), static_cast<int>(3 * sizeof(Int)),
+                            static_cast<int>(_mergedPositions.size()), _mergedPositions.data()->data(), static_cast<int>(sizeof(Vector3)));
+
+        auto cacheFilePath = levelFilePath + BvhCacheSuffix;
+        auto hash = hashMergedTriangles();
+        if (loadBvhCache(cacheFilePath, hash)) {
+            Debug{} << "Loaded level BVH from" << cacheFilePath;
+        } else {
+            _mergedShape.emplace(_mergedMesh.get(), true, true);
+            saveBvhCache(cacheFilePath, hash);
+        }
+
+        Debug{} << "Merged level collision has" << _mergedIndices.size() / 3 << "triangles and"
+                << _mergedPositions.size() << "vertices";
+
+        scene.addChild<RigidBody>(0.0f, _mergedShape.get(), world, RigidBody::CollisionLayer::Terrain).syncPose();
+
+        /* Only the merged arrays are referenced by the shape from now on */
+        _meshTriangles = {};
+    }
+
+    UnsignedLong LevelCollision::hashMergedTriangles() const {
+        UnsignedLong hash = 0xcbf29ce484222325ull;
+        hashBytes(hash, _mergedPositions.data(), _mergedPositions.size() * sizeof(Vector3));
+        hashBytes(hash, _mergedIndices.data(), _mergedIndices.size() * sizeof(Int));
+        return hash;
+    }
+
+    bool LevelCollision::loadBvhCache(Containers::StringView cacheFilePath, UnsignedLong hash) {
+        if (!Utility::Path::exists(cacheFilePath)) return false;
+
+        auto data = Utility::Path::read(cacheFilePath);
+        if (!data || data->size() < sizeof(BvhCacheHeader)) return false;
+
+        BvhCacheHeader header;
+        std::memcpy(&header, data->data(), sizeof(header));
+        if (std::memcmp(header.magic, BvhCacheMagic, sizeof(BvhCacheMagic)) != 0 ||
+            header.version != BvhCacheVersion ||
+            header.hash != hash ||
+            header.vertexCount != _mergedPositions.size() ||
+            header.triangleCount != _mergedIndices.size() / 3 ||
+            data->size() != sizeof(header) + header.bvhSize) {
+            Debug{} << "Level BVH cache" << cacheFilePath << "is stale, rebuilding";
+            return false;
+        }
+
+        _bvhCacheData = allocateBvhBuffer(header.bvhSize);
+        std::memcpy(_bvhCacheData.data(), data->data() + sizeof(header), header.bvhSize);
+        auto bvh = btOptimizedBvh::deSerializeInPlace(_bvhCacheData.data(), header.bvhSize, false);
+        if (!bvh) {
+            _bvhCacheData = {};
+            return false;
+        }
+
+        _mergedShape.emplace(_mergedMesh.get(), true, false);
+        _mergedShape->setOptimizedBvh(bvh);
+        return true;
+    }
+
+    void LevelCollision::saveBvhCache(Containers::StringView cacheFilePath, UnsignedLong hash) const {
+        auto bvh = _mergedShape->getOptimizedBvh();
+        auto bvhSize = bvh->calculateSerializeBufferSize();
+
+        auto bvhData = allocateBvhBuffer(bvhSize);
+        if (!bvh->serializeInPlace(bvhData.data(), bvhSize, false)) {
+            Warning{} << "Can't serialize the level BVH";
+            return;
+        }
+
+        BvhCacheHeader header{};
+        std::memcpy(header.magic, BvhCacheMagic, sizeof(BvhCacheMagic));
+        header.version = BvhCacheVersion;
+        header.hash = hash;
+        header.vertexCount = static_cast<UnsignedInt>(_mergedPositions.size());
+        header.triangleCount = static_cast<UnsignedInt>(_mergedIndices.size() / 3);
+        header.bvhSize = bvhSize;
+
+        Containers::Array<char> file{NoInit, sizeof(header) + bvhSize};
+        std::memcpy(file.data(), &header, sizeof(header));
+        std::memcpy(file.data() + sizeof(header), bvhData.data(), bvhSize);
+        if (Utility::Path::write(cacheFilePath, file)) {
+            Debug{} << "Saved level BVH to" << cacheFilePath;
+        } else {
+            Warning{} << "Can't save level BVH to" << cacheFilePath;
+        }
+    }
+}
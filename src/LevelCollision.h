@@ -0,0 +1,132 @@
+#pragma once
+
+#include <functional>
+#include <btBulletDynamicsCommon.h>
+#include <Corrade/Containers/Array.h>
+#include <Corrade/Containers/Pointer.h>
+#include <Corrade/Containers/StringView.h>
+#include <Magnum/Math/Range.h>
+#include <Magnum/Math/Vector3.h>
+#include <Magnum/Trade/Trade.h>
+
+#include "MagnumGameCommon.h"
+
+namespace MagnumGame {
+    class RigidBody;
+
+    enum class LevelCollisionMode {
+        /* One static body with a convex hull per level object */
+        ConvexHulls,
+        /* All level triangles merged into a single static btBvhTriangleMeshShape,
+           with the BVH cached next to the level file */
+        MergedBvh,
+    };
+
+    enum class PrimitiveCollider {
+        None,
+        Box,
+        Sphere,
+        Capsule,
+    };
+
+    /**
+     * @brief Static level collision built from the meshes of a level file
+     *
+     * Meshes named with the -collider suffix are used as the collision mesh of
+     * the mesh with the same name without it, every other mesh collides with
+     * its own vertices. With convex hulls, concave meshes are split into
+     * several hulls by @ref ConvexDecomposition. Objects named with a
+     * primitive suffix such as -box get that Bullet primitive fitted to the
+     * bounds of their mesh instead, as a body of their own in either mode.
+     * Holds no GL state.
+     */
+    class LevelCollision {
+    public:
+        static constexpr const char* ColliderSuffix = "-collider";
+        static constexpr const char* BvhCacheSuffix = ".bvh";
+        static constexpr const char* BoxSuffix = "-box";
+        static constexpr const char* SphereSuffix = "-sphere";
+        static constexpr const char* CapsuleSuffix = "-capsule";
+
+        static bool isColliderName(Containers::StringView name);
+
+        /* Ignores the .001 style numbering Blender adds to duplicated objects */
+        static PrimitiveCollider primitiveColliderForName(Containers::StringView objectName);
+
+        explicit LevelCollision(LevelCollisionMode mode = LevelCollisionMode::ConvexHulls): _mode{mode} {}
+        ~LevelCollision();
+
+        DISALLOW_COPY(LevelCollision)
+
+        LevelCollisionMode getMode() const { return _mode; }
+
+        /**
+         * @brief Builds the collision data for every mesh of the opened file
+         *
+         * @p onRenderMesh, if set, is called for every mesh that isn't a
+         * collider, so the caller can create render resources without
+         * importing the mesh again.
+         */
+        void loadShapes(Trade::AbstractImporter& importer,
+                        const std::function<void(UnsignedInt meshId, const Trade::MeshData&)>& onRenderMesh = {});
+
+        btCollisionShape* getShapeForMesh(UnsignedInt meshId) const { return _meshShapes[meshId]; }
+
+        /**
+         * @brief Adds the top-level mesh objects of a scene
+         *
+         * With convex hulls every object becomes a static body, with the merged
+         * BVH its triangles are gathered for @ref finish() and it's a plain
+         * object. @p onMeshObject, if set, is called with every object created,
+         * so the caller can attach drawables to it.
+         */
+        void addObjects(Trade::AbstractImporter& importer, const Trade::SceneData& sceneData,
+                        Scene3D& scene, btDynamicsWorld& world,
+                        const std::function<void(Object3D&, UnsignedInt meshId, Int materialId)>& onMeshObject = {});
+
+        /**
+         * @brief Creates the merged level body once all scenes are added
+         *
+         * The BVH is loaded from @p levelFilePath with @ref BvhCacheSuffix
+         * appended if that matches the merged triangles, otherwise it's built
+         * and written there. Does nothing for convex hulls.
+         */
+        void finish(Scene3D& scene, btDynamicsWorld& world, Containers::StringView levelFilePath);
+
+    private:
+        struct MeshTriangles {
+            Containers::Array<Vector3> positions;
+            Containers::Array<UnsignedInt> indices;
+        };
+
+        /* Returns the object to attach drawables to, a child of the body
+           carrying the scale Bullet can't represent */
+        Object3D& addPrimitiveObject(PrimitiveCollider primitive, const Range3D& bounds, const Matrix4& transformation,
+                                     Scene3D& scene, btDynamicsWorld& world);
+
+        /* Owned by _shapes, a compound of them if there's more than one */
+        btCollisionShape* addHullShapes(const Containers::Array<Containers::Array<Vector3>>& hulls);
+
+        bool loadBvhCache(Containers::StringView cacheFilePath, UnsignedLong hash);
+        void saveBvhCache(Containers::StringView cacheFilePath, UnsignedLong hash) const;
+        UnsignedLong hashMergedTriangles() const;
+
+        LevelCollisionMode _mode;
+
+        Containers::Array<Containers::Pointer<btCollisionShape>> _shapes{};
+        Containers::Array<btCollisionShape*> _meshShapes{};
+        Containers::Array<Range3D> _meshBounds{};
+
+        /* Merged BVH mode, collision triangles of each collision mesh in mesh
+           space, and all level triangles in world space */
+        Containers::Array<MeshTriangles> _meshTriangles{};
+        Containers::Array<Int> _meshColliders{};
+        Containers::Array<Vector3> _mergedPositions{};
+        Containers::Array<Int> _mergedIndices{};
+        Containers::Pointer<btTriangleIndexVertexArray> _mergedMesh{};
+        /* In-place deserialized BVH, the shape doesn't own it so it has to
+           outlive it */
+        Containers::Array<char> _bvhCacheData{};
+        Containers::Pointer<btBvhTriangleMeshShape> _mergedShape{};
+    };
+}
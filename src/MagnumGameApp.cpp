@@ -5,6 +5,7 @@
 #include <bullet/BulletCollision/CollisionDispatch/btGhostObject.h>
 #include <Corrade/Containers/GrowableArray.h>
 #include <Corrade/Containers/Optional.h>
+#include <Corrade/Utility/Arguments.h>
 #include <Corrade/Utility/Path.h>
 #include <Magnum/Timeline.h>
 #include <Magnum/BulletIntegration/DebugDraw.h>
@@ -72,10 +73,26 @@ namespace MagnumGame {
 
         _tweakables.emplace();
 
+        PhysicsWorld::DefaultConfiguration = PhysicsConfiguration::fromArguments(arguments.argc, arguments.argv);
+
+        Utility::Arguments gameArgs{"game"};
+        gameArgs.addOption("crowd", "0").setHelp("crowd", "spawn this many animated characters around the start", "N")
+            .addOption("animation-threads", "-1").setHelp("animation-threads", "worker threads for animation updates, -1 for one less than the hardware threads", "N")
+            .addOption("pose-cache-steps", "30").setHelp("pose-cache-steps", "share the crowd's poses at this many steps per clip second, 0 to sample each character", "N")
+            .addBooleanOption("crowd-baked").setHelp("crowd-baked", "animate the crowd on the GPU from clips baked into a texture")
+            .addBooleanOption("skin-in-shader").setHelp("skin-in-shader", "skin characters in the vertex shader of every pass instead of once a frame")
+            .addBooleanOption("no-uniform-buffers").setHelp("no-uniform-buffers", "set frame constants on every shader instead of in uniform buffers")
+            .addBooleanOption("no-scene-bvh").setHelp("no-scene-bvh", "test every drawable against the camera and shadow cascades instead of querying a BVH")
+            .addBooleanOption("compress-animations").setHelp("compress-animations", "keep animation clips compressed, decoding them as they play")
+            .setGlobalHelp("Game options")
+            .parse(arguments.argc, arguments.argv);
+
         PluginManager::Manager<Trade::AbstractImporter> manager;
 
         auto gltfImporter = manager.loadAndInstantiate("GltfImporter");
         assert(gltfImporter);
+        AnimatorAsset::CompressClips = gameArgs.isSet("compress-animations");
+        FrameUniforms::UseUniformBuffers = !gameArgs.isSet("no-uniform-buffers");
         _assets.emplace(*gltfImporter);
 
         setupUserInterface();
@@ -87,9 +104,15 @@ namespace MagnumGame {
         GL::Renderer::setBlendFunction(GL::Renderer::BlendFunction::SourceAlpha, GL::Renderer::BlendFunction::OneMinusSourceAlpha);
         GL::Renderer::setPolygonOffset(2.0f, 0.5f);
 
+        GameState::AnimationThreadCount = gameArgs.value<Int>("animation-threads");
+        GameState::SkinOnce = !gameArgs.isSet("skin-in-shader");
+        GameState::BakedCrowd = gameArgs.isSet("crowd-baked");
+        GameState::UseSceneBvh = !gameArgs.isSet("no-scene-bvh");
+        PoseCache::StepsPerSecond = gameArgs.value<Float>("pose-cache-steps");
         _gameState.emplace(_timeline, *_assets);
         _gameState->loadLevel(*gltfImporter);
         _gameState->setupPlayer();
+        _gameState->setupCrowd(gameArgs.value<UnsignedInt>("crowd"));
 
         _tweakables->addDebugMode("Friction", 0, {
                                       {
@@ -111,6 +134,37 @@ namespace MagnumGame {
                                       }
                                   });
 
+        _tweakables->addDebugMode("Simulation", 0, {
+                                      Tweakables::TweakableValue{"Tick rate", &PhysicsWorld::TickRate},
+                                      {
+                                          "Max ticks per frame", [] {
+                                              return static_cast<float>(PhysicsWorld::MaxTicksPerFrame);
+                                          },
+                                          [](float value) {
+                                              PhysicsWorld::MaxTicksPerFrame = std::max(1, static_cast<Int>(value));
+                                          }
+                                      }
+                                  });
+
+        _tweakables->addDebugMode("Physics", [&] {
+            return _gameState->getPhysicsProfiler().getSummary();
+        });
+
+        _tweakables->addDebugMode("Crowd", [&] {
+            return _gameState->getCrowdSummary();
+        });
+
+        _tweakables->addDebugMode("Rendering", [&] {
+            return _gameState->getRenderSummary();
+        });
+
+        _tweakables->addDebugMode("Animation LOD", 0, {
+                                      Tweakables::TweakableValue{"Half rate below screen size", &AnimationLod::HalfRateScreenSize},
+                                      Tweakables::TweakableValue{"Quarter rate below screen size", &AnimationLod::QuarterRateScreenSize},
+                                      Tweakables::TweakableValue{"Frozen beyond distance", &AnimationLod::MaxDistance},
+                                      Tweakables::TweakableValue{"Bounding radius", &AnimationLod::BoundingRadius},
+                                  });
+
 #ifndef CORRADE_TARGET_EMSCRIPTEN
         setSwapInterval(0);
         setMinimalLoopPeriod(8.0_msec);
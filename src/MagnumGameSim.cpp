@@ -0,0 +1,353 @@
+#include <chrono>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <BulletCollision/CollisionShapes/btCapsuleShape.h>
+#include <Corrade/Containers/Array.h>
+#include <Corrade/Containers/GrowableArray.h>
+#include <Corrade/Containers/Optional.h>
+#include <Corrade/Containers/Pointer.h>
+#include <Corrade/Containers/StringStl.h>
+#include <Corrade/PluginManager/Manager.h>
+#include <Corrade/Utility/Arguments.h>
+#include <Corrade/Utility/Debug.h>
+#include <Corrade/Utility/Path.h>
+#include <Magnum/BulletIntegration/Integration.h>
+#include <Magnum/Math/Matrix4.h>
+#include <Magnum/SceneGraph/Scene.h>
+#include <Magnum/Trade/AbstractImporter.h>
+#include <Magnum/Trade/SceneData.h>
+
+#include "AnimationState.h"
+#include "AssetPaths.h"
+#include "JobPool.h"
+#include "LevelCollision.h"
+#include "MagnumGameCommon.h"
+#include "PhysicsSnapshot.h"
+#include "PhysicsWorld.h"
+#include "Player.h"
+#include "RigidBody.h"
+#include "SceneBvhBenchmark.h"
+#include "SkeletonBenchmark.h"
+
+/*
+ * Headless simulation: loads the level collision, runs the Bullet world and
+ * the Player logic on the fixed tick without a window or GL context and
+ * reports how many ticks per second the machine manages.
+ */
+
+using namespace MagnumGame;
+
+namespace {
+    struct SimulatedPlayer {
+        Containers::Pointer<Player> player;
+        Vector3 control;
+    };
+}
+
+int main(int argc, char** argv) {
+    Utility::Arguments args;
+    args.addOption("level", "levels/level-1.glb").setHelp("level", "level file, relative to the models directory")
+        .addOption("ticks", "3600").setHelp("ticks", "number of simulation ticks to run")
+        .addOption("tick-rate", std::to_string(static_cast<Int>(PhysicsWorld::TickRate))).setHelp("tick-rate", "simulation ticks per second")
+        .addOption("players", "1").setHelp("players", "number of simulated players")
+        .addOption("seed", "0").setHelp("seed", "seed for the simulated player input")
+        .addOption("benchmark-snapshot", "0").setHelp("benchmark-snapshot", "after the run, time this many snapshot saves and restores", "N")
+        .addOption("benchmark-skeleton", "").setHelp("benchmark-skeleton", "after the run, time skeleton animation for these comma-separated character counts", "N,N,...")
+        .addOption("benchmark-crowd", "0").setHelp("benchmark-crowd", "after the run, time the animation state of a crowd of this many characters", "N")
+        .addOption("benchmark-bvh", "0").setHelp("benchmark-bvh", "after the run, time visibility queries over this many objects with and without a BVH", "N")
+        .addOption("bvh-frames", "300").setHelp("bvh-frames", "frames run by --benchmark-bvh")
+        .addOption("character", "characters/character-female-b.glb").setHelp("character", "animated model for --benchmark-skeleton and --benchmark-crowd, relative to the models directory")
+        .addOption("animation", "walk").setHelp("animation", "animation played by --benchmark-skeleton")
+        .addBooleanOption("compress-animations").setHelp("compress-animations", "compress the character's clips, report the compression of each and use them for --benchmark-crowd")
+        .addOption("animation-tolerance", "0.0005").setHelp("animation-tolerance", "error in scene units and radians --compress-animations may add by dropping keys", "E")
+        .addOption("animation-threads", "-1").setHelp("animation-threads", "worker threads besides the main one for --benchmark-crowd, -1 for one less than the hardware threads", "N")
+        .addOption("animation-frames", "300").setHelp("animation-frames", "frames animated by --benchmark-skeleton and --benchmark-crowd")
+        .addSkippedPrefix("physics", "physics backend options, see --physics-help")
+        .setGlobalHelp("Runs the game simulation headless and reports ticks per second.")
+        .parse(argc, argv);
+
+    auto modelsDir = findAssetDirectory("models");
+    if (!modelsDir) return 1;
+
+    PluginManager::Manager<Trade::AbstractImporter> manager;
+    auto importer = manager.loadAndInstantiate("GltfImporter");
+    if (!importer) return 1;
+
+    auto filePath = Utility::Path::join(*modelsDir, args.value("level"));
+    if (!importer->openFile(filePath)) {
+        Error{} << "Can't open" << filePath << "with" << importer->plugin();
+        return 1;
+    }
+
+    /* PhysicsWorld clamps the tick duration the same way, so anything lower
+       would be reported as a rate it doesn't run at */
+    const auto tickRate = args.value<Float>("tick-rate");
+    if (!(tickRate >= 1.0f)) {
+        Error{} << "--tick-rate has to be at least 1, got" << args.value("tick-rate");
+        return 1;
+    }
+    PhysicsWorld::TickRate = tickRate;
+    const auto tickCount = args.value<UnsignedInt>("ticks");
+    const auto playerCount = args.value<UnsignedInt>("players");
+
+    /* The world has to outlive the scene, as bodies remove themselves from it */
+    PhysicsWorld physics{PhysicsConfiguration::fromArguments(argc, argv)};
+    LevelCollision levelCollision{physics.getConfiguration().levelCollision};
+    btCapsuleShape playerShape{Player::CapsuleRadius, Player::CapsuleHeight};
+    Scene3D scene;
+
+    auto loadStart = std::chrono::steady_clock::now();
+    levelCollision.loadShapes(*importer);
+    for (UnsignedInt sc = 0; sc < importer->sceneCount(); sc++) {
+        if (auto sceneData = importer->scene(sc)) {
+            levelCollision.addObjects(*importer, *sceneData, scene, physics.getWorld());
+        }
+    }
+    levelCollision.finish(scene, physics.getWorld(), filePath);
+    std::chrono::duration<double> loadDuration = std::chrono::steady_clock::now() - loadStart;
+
+    Containers::Array<SimulatedPlayer> players;
+    for (UnsignedInt i = 0; i < playerCount; i++) {
+        auto& body = scene.addChild<RigidBody>(1.0f, &playerShape, physics.getWorld(), RigidBody::CollisionLayer::Dynamic);
+        auto& simulated = arrayAppend(players, InPlaceInit);
+        simulated.player.emplace("Player " + std::to_string(i), &body, nullptr);
+        /* Spread players on a grid so they don't start inside each other */
+        simulated.player->resetToStart(Matrix4::translation({Float(i % 8) - 3.5f, 2.0f, Float(i / 8) - 3.5f}));
+    }
+
+    /* Deterministic input, changing direction every couple of seconds */
+    std::mt19937 random{args.value<UnsignedInt>("seed")};
+    std::uniform_real_distribution<Float> direction{-1.0f, 1.0f};
+    const auto ticksPerInputChange = Math::max(static_cast<UnsignedInt>(2.0f * PhysicsWorld::TickRate), 1u);
+
+    const Float tickDuration = PhysicsWorld::getTickDuration();
+    auto runTick = [&] {
+        for (auto& simulated : players) {
+            simulated.player->setControl(simulated.control);
+            simulated.player->update(tickDuration);
+        }
+        physics.tick(tickDuration);
+        physics.getProfiler().endFrame();
+    };
+
+    auto simulationStart = std::chrono::steady_clock::now();
+    for (UnsignedInt tick = 0; tick < tickCount; tick++) {
+        if (tick % ticksPerInputChange == 0) {
+            for (auto& simulated : players) {
+                simulated.control = Vector3{direction(random), 0.0f, direction(random)}.normalized();
+                if (direction(random) > 0.5f) simulated.player->tryJump();
+            }
+        }
+        runTick();
+    }
+    std::chrono::duration<double> simulationDuration = std::chrono::steady_clock::now() - simulationStart;
+
+    Debug{} << "Level" << filePath << "loaded in" << loadDuration.count() * 1000.0 << "ms with"
+            << physics.getWorld().getNumCollisionObjects() << "collision objects";
+    Debug{} << "Simulated" << tickCount << "ticks at" << PhysicsWorld::TickRate << "Hz with" << playerCount << "players in"
+            << simulationDuration.count() << "s";
+    int sleepingBodies = 0;
+    auto& collisionObjects = physics.getWorld().getCollisionObjectArray();
+    for (int i = 0; i < collisionObjects.size(); i++) {
+        if (collisionObjects[i]->getActivationState() == ISLAND_SLEEPING) sleepingBodies++;
+    }
+    Debug{} << "Bodies sleeping at the end:" << sleepingBodies;
+    Debug{} << "Ticks per second:" << tickCount / simulationDuration.count() << "/"
+            << simulationDuration.count() * 1000.0 / tickCount << "ms per tick /"
+            << tickCount / simulationDuration.count() / PhysicsWorld::TickRate << "x realtime";
+
+    if (const auto iterations = args.value<UnsignedInt>("benchmark-snapshot")) {
+        PhysicsSnapshot snapshot;
+        auto save = [&] {
+            physics.saveSnapshot(snapshot);
+            resizeSnapshotArray(snapshot.players, players.size());
+            for (std::size_t i = 0; i < players.size(); i++) players[i].player->saveState(snapshot.players[i]);
+        };
+        auto restore = [&] {
+            physics.restoreSnapshot(snapshot);
+            for (std::size_t i = 0; i < players.size(); i++) players[i].player->restoreState(snapshot.players[i]);
+        };
+
+        /* The first save allocates, the rest reuse the arrays */
+        save();
+        auto saveStart = std::chrono::steady_clock::now();
+        for (UnsignedInt i = 0; i < iterations; i++) save();
+        std::chrono::duration<double> saveDuration = std::chrono::steady_clock::now() - saveStart;
+        auto restoreStart = std::chrono::steady_clock::now();
+        for (UnsignedInt i = 0; i < iterations; i++) restore();
+        std::chrono::duration<double> restoreDuration = std::chrono::steady_clock::now() - restoreStart;
+
+        /* The timing loop left the world restored, without any contacts.
+           Run it live for a while so the manifolds warm up again, save,
+           record where the live world ends up, then roll back and run the
+           same input again. A restore drops the contact manifolds, so the
+           re-run starts without warm starting and can drift from the live
+           run, the deviation shows by how much */
+        const UnsignedInt rollbackTicks = Math::max(static_cast<UnsignedInt>(PhysicsWorld::TickRate), 1u);
+        for (UnsignedInt tick = 0; tick < rollbackTicks; tick++) runTick();
+        save();
+        for (UnsignedInt tick = 0; tick < rollbackTicks; tick++) runTick();
+        auto bodyPosition = [&](std::size_t i) {
+            return Vector3{players[i].player->getBody()->rigidBody().getWorldTransform().getOrigin()};
+        };
+        Containers::Array<Vector3> liveRun;
+        for (std::size_t i = 0; i < players.size(); i++) arrayAppend(liveRun, bodyPosition(i));
+        restore();
+        for (UnsignedInt tick = 0; tick < rollbackTicks; tick++) runTick();
+        Float maxDeviation = 0.0f;
+        for (std::size_t i = 0; i < players.size(); i++) {
+            maxDeviation = Math::max(maxDeviation, (bodyPosition(i) - liveRun[i]).length());
+        }
+
+        Debug{} << "Snapshot of" << snapshot.bodies.size() << "bodies and" << snapshot.players.size() << "players is"
+                << snapshot.getByteSize() << "bytes";
+        Debug{} << "Snapshot save" << saveDuration.count() * 1.0e6 / iterations << "us, restore"
+                << restoreDuration.count() * 1.0e6 / iterations << "us";
+        Debug{} << "Position deviation from the live run after rolling back" << rollbackTicks << "ticks:" << maxDeviation;
+    }
+
+    if (const auto objectCount = args.value<UnsignedInt>("benchmark-bvh")) {
+        auto result = SceneBvhBenchmark::run(objectCount, args.value<UnsignedInt>("bvh-frames"));
+        Debug{} << "Visibility of" << objectCount << "objects in a camera and 4 cascades:" << result.averageVisible
+                << "visible," << result.averageCandidates << "BVH candidates per frame";
+        Debug{} << "    every object" << result.bruteForceMilliseconds << "ms, BVH" << result.bvhMilliseconds
+                << "ms per frame (refit" << result.refitMilliseconds << "ms)," << result.bruteForceMilliseconds / result.bvhMilliseconds
+                << "x faster";
+        Debug{} << "    sphere query" << result.bruteForceSphereMicroseconds << "->" << result.bvhSphereMicroseconds
+                << "us, ray query" << result.bruteForceRayMicroseconds << "->" << result.bvhRayMicroseconds << "us";
+        if (result.mismatches) Error{} << "BVH and every object disagree in" << result.mismatches << "queries";
+    }
+
+    const auto characterCounts = args.value("benchmark-skeleton");
+    const auto crowdSize = args.value<UnsignedInt>("benchmark-crowd");
+    const bool compressAnimations = args.isSet("compress-animations");
+    if (!characterCounts.empty() || crowdSize || compressAnimations) {
+        auto characterImporter = manager.loadAndInstantiate("GltfImporter");
+        auto characterPath = Utility::Path::join(*modelsDir, args.value("character"));
+        if (!characterImporter || !characterImporter->openFile(characterPath)) {
+            Error{} << "Can't open" << characterPath;
+            return 1;
+        }
+        const auto frameCount = args.value<UnsignedInt>("animation-frames");
+
+        if (!characterCounts.empty()) {
+            SkeletonBenchmark benchmark{*characterImporter, args.value("animation")};
+            if (!benchmark.isValid()) return 1;
+
+            for (auto count : Containers::StringView{characterCounts}.splitWithoutEmptyParts(',')) {
+                const std::string countString{count};
+                UnsignedInt characterCount;
+                try {
+                    std::size_t end;
+                    characterCount = UnsignedInt(std::stoul(countString, &end));
+                    if (end != countString.size()) throw std::invalid_argument{countString};
+                } catch (const std::logic_error&) {
+                    Error{} << "Invalid character count" << countString << "in --benchmark-skeleton";
+                    return 1;
+                }
+                auto result = benchmark.run(characterCount, frameCount);
+                Debug{} << "Skeletons of" << characterCount << "characters: scene graph"
+                        << result.sceneGraphMilliseconds << "ms, flat" << result.flatMilliseconds << "ms, clip"
+                        << result.clipMilliseconds << "ms per frame," << result.sceneGraphMilliseconds / result.clipMilliseconds
+                        << "x faster, max joint matrix difference" << result.maxDifference << "/" << result.clipMaxDifference;
+            }
+        }
+
+        if (crowdSize || compressAnimations) {
+            /* Same split as the game: the skeleton and clips are shared, each
+               character only has an AnimationState */
+            SkeletonAsset skeleton{*characterImporter};
+            Containers::Array<AnimationClip> clips;
+            Containers::Array<Containers::String> clipNames;
+            for (UnsignedInt i = 0; i < characterImporter->animationCount(); i++) {
+                if (auto animation = characterImporter->animation(i)) {
+                    arrayAppend(clips, InPlaceInit, *animation, skeleton);
+                    arrayAppend(clipNames, characterImporter->animationName(i));
+                }
+            }
+            if (clips.isEmpty()) {
+                Error{} << characterPath << "has no animations";
+                return 1;
+            }
+
+            if (compressAnimations) {
+                const Float tolerance = args.value<Float>("animation-tolerance");
+                const AnimationCompression compression{tolerance, tolerance, tolerance};
+                SkeletonPose pose{skeleton};
+                for (UnsignedInt i = 0; i < clips.size(); i++) {
+                    auto& clip = clips[i];
+                    auto sampleAll = [&] {
+                        auto start = std::chrono::steady_clock::now();
+                        for (UnsignedInt frame = 0; frame < frameCount; frame++) {
+                            clip.sampleLooped(Float(frame) / 60.0f, pose);
+                        }
+                        std::chrono::duration<double, std::micro> duration = std::chrono::steady_clock::now() - start;
+                        return duration.count() / Math::max(frameCount, 1u);
+                    };
+
+                    const double originalSample = sampleAll();
+                    auto result = clip.compress(compression);
+                    const double compressedSample = sampleAll();
+                    Debug{} << "Clip" << clipNames[i] << Debug::nospace << ":" << result.originalKeyCount
+                            << "->" << result.keyCount << "keys," << result.originalByteSize << "->" << result.byteSize
+                            << "bytes," << result.getRatio() << "x smaller";
+                    Debug{} << "    max error" << result.maxTranslationError << "translation," << result.maxRotationError
+                            << "rad rotation," << result.maxScalingError << "scaling, sample" << originalSample
+                            << "->" << compressedSample << "us";
+                }
+            }
+
+            if (crowdSize) {
+                std::size_t sharedBytes = 0;
+                for (auto& clip : clips) sharedBytes += clip.getByteSize();
+
+                std::uniform_real_distribution<Float> unit{0.0f, 1.0f};
+                Containers::Array<Containers::Pointer<AnimationState>> crowd{crowdSize};
+                for (UnsignedInt i = 0; i < crowdSize; i++) {
+                    auto& state = *(crowd[i] = Containers::Pointer<AnimationState>{InPlaceInit, skeleton});
+                    auto& clip = clips[i % clips.size()];
+                    state.play(clip, true);
+                    state.setTime(unit(random) * clip.getDuration().size());
+                    state.setSpeed(0.8f + 0.4f * unit(random));
+                }
+
+                const Float frameDuration = 1.0f / 60.0f;
+                auto crowdStart = std::chrono::steady_clock::now();
+                for (UnsignedInt frame = 0; frame < frameCount; frame++) {
+                    for (auto& state : crowd) {
+                        state->advance(frameDuration);
+                        state->update();
+                    }
+                }
+                std::chrono::duration<double> crowdDuration = std::chrono::steady_clock::now() - crowdStart;
+
+                /* The same update split into jobs the way GameState does it */
+                JobPool jobs{args.value<Int>("animation-threads")};
+                const auto perJob = UnsignedInt(Math::max(AnimationState::UpdatesPerJob, 1));
+                const UnsignedInt jobCount = (crowdSize + perJob - 1) / perJob;
+                auto parallelStart = std::chrono::steady_clock::now();
+                for (UnsignedInt frame = 0; frame < frameCount; frame++) {
+                    jobs.run(jobCount, [&](UnsignedInt job) {
+                        for (UnsignedInt i = job * perJob, end = Math::min(i + perJob, crowdSize); i < end; i++) {
+                            crowd[i]->advance(frameDuration);
+                            crowd[i]->update();
+                        }
+                    });
+                }
+                std::chrono::duration<double> parallelDuration = std::chrono::steady_clock::now() - parallelStart;
+
+                Debug{} << "Crowd of" << crowdSize << "characters with" << skeleton.getBoneCount() << "bones and"
+                        << clips.size() << "clips:" << crowd[0]->getByteSize() << "bytes per instance,"
+                        << sharedBytes << "bytes of shared clips";
+                Debug{} << "Crowd animation update" << crowdDuration.count() * 1000.0 / Math::max(frameCount, 1u) << "ms per frame,"
+                        << crowdDuration.count() * 1.0e6 / Math::max(frameCount, 1u) / crowdSize << "us per instance";
+                Debug{} << "Crowd animation update on" << jobs.getThreadCount() + 1 << "threads"
+                        << parallelDuration.count() * 1000.0 / Math::max(frameCount, 1u) << "ms per frame,"
+                        << crowdDuration.count() / parallelDuration.count() << "x faster";
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,181 @@
+#include "PhysicsProfiler.h"
+
+#include <cstring>
+#include <sstream>
+#include <Corrade/Containers/GrowableArray.h>
+#include <Corrade/Containers/Optional.h>
+#include <Corrade/Containers/String.h>
+#include <Corrade/Utility/Debug.h>
+#include <Corrade/Utility/Path.h>
+#include <LinearMath/btQuickprof.h>
+
+namespace MagnumGame {
+
+    bool PhysicsProfiler::setCsvPath(Containers::StringView path) {
+        if (_csv.is_open()) _csv.close();
+        _csvHeaderWritten = false;
+        arrayRemove(_csvZoneNames, 0, _csvZoneNames.size());
+        _csvPath = path;
+        if (path.isEmpty()) return true;
+
+        _csv.open(_csvPath.data());
+        if (!_csv) {
+            Warning{} << "Can't open" << path << "for the physics profile";
+            return false;
+        }
+        return true;
+    }
+
+    void PhysicsProfiler::recordTick(btDynamicsWorld& world, Int substeps, Float stepMilliseconds, Int groundedBodies) {
+        _frame.ticks++;
+        _frame.substeps += substeps;
+        _frame.stepMilliseconds += stepMilliseconds;
+
+        /* Counts are the state after the last tick of the frame */
+        _frame.overlappingPairs = world.getBroadphase()->getOverlappingPairCache()->getNumOverlappingPairs();
+        auto dispatcher = world.getDispatcher();
+        _frame.manifolds = dispatcher->getNumManifolds();
+        _frame.contacts = 0;
+        for (int i = 0; i < _frame.manifolds; i++) {
+            _frame.contacts += dispatcher->getManifoldByIndexInternal(i)->getNumContacts();
+        }
+        _frame.activeBodies = 0;
+        auto& collisionObjects = world.getCollisionObjectArray();
+        for (int i = 0; i < collisionObjects.size(); i++) {
+            if (!collisionObjects[i]->isStaticOrKinematicObject() && collisionObjects[i]->isActive()) _frame.activeBodies++;
+        }
+        _frame.groundedBodies = groundedBodies;
+
+        recordZones();
+    }
+
+    void PhysicsProfiler::recordZones() {
+#ifndef BT_NO_PROFILE
+        /* stepSimulation() resets the profile tree, so it only ever holds the
+           last step */
+        auto iterator = CProfileManager::Get_Iterator();
+        auto visit = [&](auto& self, Int depth) -> void {
+            for (iterator->First(); !iterator->Is_Done(); iterator->Next()) {
+                auto& zone = zoneFor(iterator->Get_Current_Name(), depth);
+                zone.milliseconds += iterator->Get_Current_Total_Time();
+                zone.calls += iterator->Get_Current_Total_Calls();
+            }
+            if (depth >= MaxZoneDepth) return;
+
+            Int childIndex = 0;
+            for (iterator->First(); !iterator->Is_Done(); iterator->Next(), childIndex++) {}
+            for (Int i = 0; i < childIndex; i++) {
+                iterator->Enter_Child(i);
+                self(self, depth + 1);
+                iterator->Enter_Parent();
+            }
+        };
+        visit(visit, 0);
+        CProfileManager::Release_Iterator(iterator);
+#endif
+    }
+
+    PhysicsProfiler::Zone& PhysicsProfiler::zoneFor(const char* name, Int depth) {
+        for (auto& zone : _zones) {
+            if (zone.depth == depth && (zone.name == name || std::strcmp(zone.name, name) == 0)) return zone;
+        }
+        return arrayAppend(_zones, Zone{name, depth, 0.0f, 0});
+    }
+
+    void PhysicsProfiler::endFrame() {
+        _lastFrame = _frame;
+
+        /* Keep the zone list and its order between frames so the overlay
+           doesn't jump around, only reset the sums */
+        arrayResize(_lastZones, NoInit, _zones.size());
+        for (std::size_t i = 0; i < _zones.size(); i++) {
+            _lastZones[i] = _zones[i];
+            _zones[i].milliseconds = 0.0f;
+            _zones[i].calls = 0;
+        }
+
+        if (_csv.is_open()) writeCsvRow();
+
+        auto index = _frame.index + 1;
+        _frame = {};
+        _frame.index = index;
+    }
+
+    void PhysicsProfiler::writeCsvHeader() {
+        _csv << "frame,ticks,substeps,step_ms,pairs,manifolds,contacts,active_bodies,grounded_bodies";
+        for (auto name : _csvZoneNames) _csv << ',' << name << "_ms";
+        _csv << '\n';
+    }
+
+    void PhysicsProfiler::addCsvColumns(std::size_t previousZoneCount) {
+        /* Rare, only while new zones show up, so the rows so far are read
+           back and written again with empty cells for the new columns */
+        _csv.close();
+        auto contents = Utility::Path::readString(_csvPath);
+        _csv.open(_csvPath.data(), std::ios::trunc);
+        if (!contents || !_csv) {
+            Warning{} << "Can't rewrite" << _csvPath << "with new physics profile columns";
+            return;
+        }
+
+        writeCsvHeader();
+        auto rows = contents->splitWithoutEmptyParts('\n');
+        for (std::size_t i = 1; i < rows.size(); i++) {
+            _csv.write(rows[i].data(), std::streamsize(rows[i].size()));
+            for (std::size_t column = previousZoneCount; column < _csvZoneNames.size(); column++) _csv << ',';
+            _csv << '\n';
+        }
+    }
+
+    void PhysicsProfiler::writeCsvRow() {
+        /* Zones only appear in frames that ran a tick, and some, like island
+           solving, only later on, each gets a column when first seen */
+        const std::size_t previousZoneCount = _csvZoneNames.size();
+        for (auto& zone : _lastZones) {
+            bool known = false;
+            for (auto name : _csvZoneNames) {
+                if (name == zone.name || std::strcmp(name, zone.name) == 0) {
+                    known = true;
+                    break;
+                }
+            }
+            if (!known) arrayAppend(_csvZoneNames, zone.name);
+        }
+
+        if (!_csvHeaderWritten) {
+            writeCsvHeader();
+            _csvHeaderWritten = true;
+        } else if (_csvZoneNames.size() != previousZoneCount) {
+            addCsvColumns(previousZoneCount);
+            if (!_csv.is_open()) return;
+        }
+
+        _csv << _lastFrame.index << ',' << _lastFrame.ticks << ',' << _lastFrame.substeps << ','
+             << _lastFrame.stepMilliseconds << ',' << _lastFrame.overlappingPairs << ',' << _lastFrame.manifolds << ','
+             << _lastFrame.contacts << ',' << _lastFrame.activeBodies << ',' << _lastFrame.groundedBodies;
+        for (auto name : _csvZoneNames) {
+            Float milliseconds = 0.0f;
+            for (auto& zone : _lastZones) {
+                if (zone.name == name || std::strcmp(zone.name, name) == 0) milliseconds += zone.milliseconds;
+            }
+            _csv << ',' << milliseconds;
+        }
+        _csv << '\n';
+    }
+
+    std::string PhysicsProfiler::getSummary() const {
+        std::ostringstream os;
+        Debug debug{&os, Debug::Flag::NoNewlineAtTheEnd};
+        debug << "Ticks" << _lastFrame.ticks << "substeps" << _lastFrame.substeps
+              << "step" << _lastFrame.stepMilliseconds << "ms";
+        debug << Debug::newline << "Pairs" << _lastFrame.overlappingPairs << "manifolds" << _lastFrame.manifolds
+              << "contacts" << _lastFrame.contacts;
+        debug << Debug::newline << "Active bodies" << _lastFrame.activeBodies << "grounded" << _lastFrame.groundedBodies;
+        for (auto& zone : _lastZones) {
+            if (zone.calls == 0) continue;
+            debug << Debug::newline << std::string(std::size_t(zone.depth) * 2, ' ').c_str() << Debug::nospace
+                  << zone.name << zone.milliseconds << "ms" << zone.calls << "calls";
+        }
+        return os.str();
+    }
+}
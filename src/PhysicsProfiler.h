@@ -0,0 +1,82 @@
+#pragma once
+
+#include <fstream>
+#include <string>
+#include <btBulletDynamicsCommon.h>
+#include <Corrade/Containers/Array.h>
+#include <Corrade/Containers/String.h>
+#include <Corrade/Containers/StringView.h>
+
+#include "MagnumGameCommon.h"
+
+namespace MagnumGame {
+
+    /**
+     * @brief Where the physics time of a frame went
+     *
+     * Collects the BT_PROFILE zones Bullet records during each
+     * stepSimulation(), together with broadphase pair, manifold, contact and
+     * body counts, summed over all ticks of a frame. Optionally writes one CSV
+     * row per frame. Holds no GL state.
+     */
+    class PhysicsProfiler {
+    public:
+        struct Zone {
+            /* Bullet's zone names are string literals, compared by pointer first */
+            const char* name;
+            Int depth;
+            Float milliseconds;
+            UnsignedInt calls;
+        };
+
+        struct Frame {
+            UnsignedLong index;
+            Int ticks;
+            Int substeps;
+            Float stepMilliseconds;
+            Int overlappingPairs;
+            Int manifolds;
+            Int contacts;
+            Int activeBodies;
+            Int groundedBodies;
+        };
+
+        /* Zones nested deeper than this aren't listed, their time is still
+           included in their parent's */
+        inline static Int MaxZoneDepth = 2;
+
+        /* Writes a row per frame to @p path from the next frame on, an empty
+           path stops writing */
+        bool setCsvPath(Containers::StringView path);
+
+        /* Call after every stepSimulation() with the substeps it returned */
+        void recordTick(btDynamicsWorld& world, Int substeps, Float stepMilliseconds, Int groundedBodies);
+
+        /* Finishes the frame for getLastFrame() and the CSV and starts a new one */
+        void endFrame();
+
+        const Frame& getLastFrame() const { return _lastFrame; }
+        const Containers::Array<Zone>& getLastZones() const { return _lastZones; }
+
+        std::string getSummary() const;
+
+    private:
+        void recordZones();
+        Zone& zoneFor(const char* name, Int depth);
+        void writeCsvHeader();
+        /* Rewrites the file for the zones after @p previousZoneCount */
+        void addCsvColumns(std::size_t previousZoneCount);
+        void writeCsvRow();
+
+        Frame _frame{};
+        Containers::Array<Zone> _zones{};
+        Frame _lastFrame{};
+        Containers::Array<Zone> _lastZones{};
+
+        std::ofstream _csv;
+        Containers::String _csvPath;
+        /* Columns of the CSV, in the order the zones were first seen */
+        Containers::Array<const char*> _csvZoneNames{};
+        bool _csvHeaderWritten{};
+    };
+}
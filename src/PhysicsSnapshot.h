@@ -0,0 +1,51 @@
+#pragma once
+
+#include <Corrade/Containers/Array.h>
+#include <Magnum/Math/Quaternion.h>
+#include <Magnum/Math/Vector3.h>
+
+#include "MagnumGameCommon.h"
+
+namespace MagnumGame {
+
+    /**
+     * @brief Flat copy of the simulation state, for rollback and prediction
+     *
+     * Bodies are stored in the order of the world's collision object array,
+     * so a snapshot only restores into a world with the same dynamic bodies
+     * added in the same order. Saving into the same snapshot again reuses its
+     * arrays, so it only allocates when the number of bodies changes.
+     */
+    struct PhysicsSnapshot {
+        struct Body {
+            Vector3 position;
+            Quaternion rotation;
+            Vector3 linearVelocity;
+            Vector3 angularVelocity;
+            Float deactivationTime;
+            Int activationState;
+            bool onGround;
+        };
+
+        struct Player {
+            Vector3 control;
+            bool jumpQueued;
+            bool onGround;
+        };
+
+        UnsignedLong tickCount{};
+        Float tickAccumulator{};
+        Containers::Array<Body> bodies{};
+        Containers::Array<Player> players{};
+
+        std::size_t getByteSize() const {
+            return sizeof(tickCount) + sizeof(tickAccumulator) +
+                   bodies.size() * sizeof(Body) + players.size() * sizeof(Player);
+        }
+    };
+
+    /* Resizes without keeping the contents, only allocating if the size changes */
+    template<class T> void resizeSnapshotArray(Containers::Array<T>& array, std::size_t size) {
+        if (array.size() != size) array = Containers::Array<T>{NoInit, size};
+    }
+}
@@ -0,0 +1,293 @@
+#include "PhysicsWorld.h"
+
+#include <chrono>
+#include <cmath>
+#include <BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h>
+#include <BulletDynamics/ConstraintSolver/btNNCGConstraintSolver.h>
+#include <Corrade/Containers/GrowableArray.h>
+#include <Corrade/Utility/Arguments.h>
+#include <Corrade/Utility/Debug.h>
+#include <Magnum/BulletIntegration/Integration.h>
+#include <LinearMath/btThreads.h>
+#if BT_BULLET_VERSION >= 288
+#include <BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolverMt.h>
+#endif
+
+#include "RigidBody.h"
+
+namespace MagnumGame {
+
+    bool PhysicsConfiguration::setBackend(Containers::StringView name) {
+        if (name == "discrete") backend = PhysicsBackend::Discrete;
+        else if (name == "mt") backend = PhysicsBackend::DiscreteMt;
+        else return false;
+        return true;
+    }
+
+    bool PhysicsConfiguration::setSolver(Containers::StringView name) {
+        if (name == "si") solver = PhysicsSolver::SequentialImpulse;
+        else if (name == "simd") solver = PhysicsSolver::SequentialImpulseSimd;
+        else if (name == "nncg") solver = PhysicsSolver::NonlinearConjugateGradient;
+        else return false;
+        return true;
+    }
+
+    bool PhysicsConfiguration::setTaskScheduler(Containers::StringView name) {
+        if (name == "sequential") taskScheduler = PhysicsTaskScheduler::Sequential;
+        else if (name == "std") taskScheduler = PhysicsTaskScheduler::StdThread;
+        else if (name == "openmp") taskScheduler = PhysicsTaskScheduler::OpenMP;
+        else return false;
+        return true;
+    }
+
+    bool PhysicsConfiguration::setLevelCollision(Containers::StringView name) {
+        if (name == "hulls") levelCollision = LevelCollisionMode::ConvexHulls;
+        else if (name == "bvh") levelCollision = LevelCollisionMode::MergedBvh;
+        else return false;
+        return true;
+    }
+
+    PhysicsConfiguration PhysicsConfiguration::fromArguments(int argc, const char* const* argv) {
+        Utility::Arguments args{"physics"};
+        args.addOption("backend", "discrete").setHelp("backend", "dynamics world, discrete or mt")
+            .addOption("solver", "simd").setHelp("solver", "constraint solver, si, simd or nncg")
+            .addOption("scheduler", "std").setHelp("scheduler", "task scheduler for the mt backend, sequential, std or openmp")
+            .addOption("threads", "0").setHelp("threads", "task scheduler threads, 0 for its default")
+            .addOption("level-collision", "hulls").setHelp("level-collision", "static level collision, hulls or bvh")
+            .addOption("profile-csv").setHelp("profile-csv", "write physics profile counters per frame to a CSV file", "file")
+            .setGlobalHelp("Physics options");
+        args.parse(argc, argv);
+
+        PhysicsConfiguration configuration;
+        if (!configuration.setBackend(args.value("backend"))) {
+            Warning{} << "Unknown physics backend" << args.value("backend");
+        }
+        if (!configuration.setSolver(args.value("solver"))) {
+            Warning{} << "Unknown physics solver" << args.value("solver");
+        }
+        if (!configuration.setTaskScheduler(args.value("scheduler"))) {
+            Warning{} << "Unknown physics task scheduler" << args.value("scheduler");
+        }
+        if (!configuration.setLevelCollision(args.value("level-collision"))) {
+            Warning{} << "Unknown level collision mode" << args.value("level-collision");
+        }
+        configuration.threadCount = args.value<Int>("threads");
+        configuration.profileCsvPath = args.value("profile-csv");
+        return configuration;
+    }
+
+    PhysicsWorld::PhysicsWorld(const PhysicsConfiguration& configuration)
+        : _configuration(configuration) {
+
+        if (_configuration.backend == PhysicsBackend::DiscreteMt) {
+            setupTaskScheduler();
+
+            _bDispatcher.emplace<btCollisionDispatcherMt>(&_bCollisionConfig);
+
+            /* One solver per thread, each island is solved by whichever is free */
+            auto solverCount = btGetTaskScheduler()->getNumThreads();
+            Containers::Array<btConstraintSolver*> poolSolvers;
+            for (auto i = 0; i < solverCount; i++) {
+                arrayAppend(poolSolvers, arrayAppend(_bPoolSolvers, createSolver(_configuration.solver)).get());
+            }
+            _bSolverPool.emplace(poolSolvers.data(), solverCount);
+#if BT_BULLET_VERSION >= 288
+            /* Large islands are split across threads by the MT solver, it only
+               exists as a sequential impulse variant */
+            if (_configuration.solver != PhysicsSolver::NonlinearConjugateGradient) {
+                _bSolver.emplace<btSequentialImpulseConstraintSolverMt>();
+            }
+            _bWorld.emplace<btDiscreteDynamicsWorldMt>(_bDispatcher.get(), &_bBroadphase, _bSolverPool.get(),
+                                                       _bSolver.get(), &_bCollisionConfig);
+#else
+            _bWorld.emplace<btDiscreteDynamicsWorldMt>(_bDispatcher.get(), &_bBroadphase, _bSolverPool.get(),
+                                                       &_bCollisionConfig);
+#endif
+        } else {
+            _bDispatcher.emplace(&_bCollisionConfig);
+            _bSolver = createSolver(_configuration.solver);
+            _bWorld.emplace(_bDispatcher.get(), &_bBroadphase, _bSolver.get(), &_bCollisionConfig);
+        }
+
+        auto& solverMode = _bWorld->getSolverInfo().m_solverMode;
+        if (_configuration.solver == PhysicsSolver::SequentialImpulseSimd) {
+            solverMode |= SOLVER_SIMD;
+        } else {
+            solverMode &= ~SOLVER_SIMD;
+        }
+
+        _bWorld->setGravity({0.0f, -10.0f, 0.0f});
+        /* Static and sleeping bodies keep their AABBs, RigidBody::syncPose()
+           updates them when they're moved */
+        _bWorld->setForceUpdateAllAabbs(false);
+
+        if (!_configuration.profileCsvPath.isEmpty()) {
+            _profiler.setCsvPath(_configuration.profileCsvPath);
+        }
+    }
+
+    PhysicsWorld::~PhysicsWorld() = default;
+
+    Containers::Pointer<btConstraintSolver> PhysicsWorld::createSolver(PhysicsSolver solver) {
+        switch (solver) {
+            case PhysicsSolver::NonlinearConjugateGradient:
+                return Containers::Pointer<btConstraintSolver>{new btNNCGConstraintSolver};
+            case PhysicsSolver::SequentialImpulse:
+            case PhysicsSolver::SequentialImpulseSimd:
+            default:
+                return Containers::Pointer<btConstraintSolver>{new btSequentialImpulseConstraintSolver};
+        }
+    }
+
+    void PhysicsWorld::setupTaskScheduler() {
+        /* The scheduler is global in Bullet, so keep the one we create alive
+           for the lifetime of the process */
+        static Containers::Pointer<btITaskScheduler> defaultScheduler;
+
+        btITaskScheduler* scheduler = nullptr;
+        switch (_configuration.taskScheduler) {
+            case PhysicsTaskScheduler::StdThread:
+                if (!defaultScheduler) defaultScheduler.reset(btCreateDefaultTaskScheduler());
+                scheduler = defaultScheduler.get();
+                break;
+            case PhysicsTaskScheduler::OpenMP:
+                scheduler = btGetOpenMPTaskScheduler();
+                break;
+            case PhysicsTaskScheduler::Sequential:
+                break;
+        }
+        if (!scheduler) {
+            if (_configuration.taskScheduler != PhysicsTaskScheduler::Sequential) {
+                Warning{} << "Requested Bullet task scheduler isn't available in this build, running sequentially";
+            }
+            scheduler = btGetSequentialTaskScheduler();
+        }
+        if (_configuration.threadCount > 0) {
+            scheduler->setNumThreads(Math::min(_configuration.threadCount, scheduler->getMaxNumThreads()));
+        }
+        btSetTaskScheduler(scheduler);
+        Debug{} << "Physics using" << scheduler->getName() << "task scheduler with" << scheduler->getNumThreads() << "threads";
+    }
+
+    Int PhysicsWorld::advance(Float frameDuration, const std::function<void(Float)>& preTick) {
+        const Float tickDuration = getTickDuration();
+
+        _tickAccumulator += frameDuration;
+        Int ticks = 0;
+        while (_tickAccumulator >= tickDuration && ticks < MaxTicksPerFrame) {
+            if (preTick) preTick(tickDuration);
+            tick(tickDuration);
+            _tickAccumulator -= tickDuration;
+            ticks++;
+        }
+        if (_tickAccumulator >= tickDuration) {
+            /* Too far behind, drop the whole ticks we couldn't afford */
+            _tickAccumulator = std::fmod(_tickAccumulator, tickDuration);
+        }
+        _profiler.endFrame();
+        return ticks;
+    }
+
+    void PhysicsWorld::tick(Float tickDuration) {
+        auto stepStart = std::chrono::steady_clock::now();
+        auto substeps = _bWorld->stepSimulation(tickDuration, 1, tickDuration);
+
+        auto& collisionObjects = _bWorld->getCollisionObjectArray();
+        for (int i = 0; i < collisionObjects.size(); i++) {
+            auto collisionObject = collisionObjects[i];
+            if (collisionObject->isStaticOrKinematicObject()) continue;
+            if (auto rigidBody = RigidBody::fromCollisionObject(collisionObject)) {
+                rigidBody->captureTickPose();
+            }
+        }
+        _groundContacts.update(*_bWorld);
+        std::chrono::duration<Float, std::milli> stepDuration = std::chrono::steady_clock::now() - stepStart;
+        _profiler.recordTick(*_bWorld, substeps, stepDuration.count(), Int(_groundContacts.getGroundedCount()));
+        _tickCount++;
+    }
+
+    void PhysicsWorld::saveSnapshot(PhysicsSnapshot& snapshot) const {
+        auto& collisionObjects = _bWorld->getCollisionObjectArray();
+        std::size_t bodyCount = 0;
+        for (int i = 0; i < collisionObjects.size(); i++) {
+            if (!collisionObjects[i]->isStaticOrKinematicObject()) bodyCount++;
+        }
+        resizeSnapshotArray(snapshot.bodies, bodyCount);
+
+        std::size_t b = 0;
+        for (int i = 0; i < collisionObjects.size(); i++) {
+            auto collisionObject = collisionObjects[i];
+            if (collisionObject->isStaticOrKinematicObject()) continue;
+
+            auto bRigidBody = btRigidBody::upcast(collisionObject);
+            auto rigidBody = RigidBody::fromCollisionObject(collisionObject);
+            auto& body = snapshot.bodies[b++];
+            body.position = Vector3{collisionObject->getWorldTransform().getOrigin()};
+            body.rotation = Quaternion{collisionObject->getWorldTransform().getRotation()};
+            body.linearVelocity = bRigidBody ? Vector3{bRigidBody->getLinearVelocity()} : Vector3{};
+            body.angularVelocity = bRigidBody ? Vector3{bRigidBody->getAngularVelocity()} : Vector3{};
+            body.deactivationTime = collisionObject->getDeactivationTime();
+            body.activationState = collisionObject->getActivationState();
+            body.onGround = rigidBody && rigidBody->isOnGround();
+        }
+
+        snapshot.tickCount = _tickCount;
+        snapshot.tickAccumulator = _tickAccumulator;
+    }
+
+    bool PhysicsWorld::restoreSnapshot(const PhysicsSnapshot& snapshot) {
+        auto& collisionObjects = _bWorld->getCollisionObjectArray();
+        std::size_t bodyCount = 0;
+        for (int i = 0; i < collisionObjects.size(); i++) {
+            if (!collisionObjects[i]->isStaticOrKinematicObject()) bodyCount++;
+        }
+        if (bodyCount != snapshot.bodies.size()) {
+            Warning{} << "Physics snapshot has" << snapshot.bodies.size() << "bodies but the world has" << bodyCount;
+            return false;
+        }
+
+        std::size_t b = 0;
+        for (int i = 0; i < collisionObjects.size(); i++) {
+            auto collisionObject = collisionObjects[i];
+            if (collisionObject->isStaticOrKinematicObject()) continue;
+
+            auto& body = snapshot.bodies[b++];
+            if (auto rigidBody = RigidBody::fromCollisionObject(collisionObject)) {
+                rigidBody->restorePose(body.position, body.rotation);
+                rigidBody->setOnGround(body.onGround);
+            } else {
+                collisionObject->setWorldTransform(btTransform{btQuaternion{body.rotation}, btVector3{body.position}});
+                collisionObject->setInterpolationWorldTransform(collisionObject->getWorldTransform());
+            }
+            if (auto bRigidBody = btRigidBody::upcast(collisionObject)) {
+                bRigidBody->setLinearVelocity(btVector3{body.linearVelocity});
+                bRigidBody->setAngularVelocity(btVector3{body.angularVelocity});
+                bRigidBody->setInterpolationLinearVelocity(btVector3{body.linearVelocity});
+                bRigidBody->setInterpolationAngularVelocity(btVector3{body.angularVelocity});
+                bRigidBody->clearForces();
+            }
+            collisionObject->forceActivationState(body.activationState);
+            collisionObject->setDeactivationTime(body.deactivationTime);
+            if (collisionObject->getBroadphaseHandle()) _bWorld->updateSingleAabb(collisionObject);
+        }
+
+        for (int i = 0; i < _bDispatcher->getNumManifolds(); i++) {
+            _bDispatcher->getManifoldByIndexInternal(i)->clearManifold();
+        }
+
+        _tickCount = snapshot.tickCount;
+        _tickAccumulator = snapshot.tickAccumulator;
+        return true;
+    }
+
+    void PhysicsWorld::interpolateDynamicBodies(Float alpha) {
+        auto& collisionObjects = _bWorld->getCollisionObjectArray();
+        for (int i = 0; i < collisionObjects.size(); i++) {
+            auto collisionObject = collisionObjects[i];
+            if (collisionObject->isStaticOrKinematicObject()) continue;
+            if (auto rigidBody = RigidBody::fromCollisionObject(collisionObject)) {
+                rigidBody->interpolateTickPose(alpha);
+            }
+        }
+    }
+}
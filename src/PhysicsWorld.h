@@ -0,0 +1,160 @@
+#pragma once
+
+#include <functional>
+#include <btBulletDynamicsCommon.h>
+#include <BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h>
+#include <Corrade/Containers/Array.h>
+#include <Corrade/Containers/Pointer.h>
+#include <Corrade/Containers/String.h>
+#include <Corrade/Containers/StringView.h>
+#include <Magnum/Math/Functions.h>
+
+#include "GroundContacts.h"
+#include "LevelCollision.h"
+#include "PhysicsProfiler.h"
+#include "PhysicsSnapshot.h"
+#include "MagnumGameCommon.h"
+
+namespace MagnumGame {
+
+    enum class PhysicsBackend {
+        /* btDiscreteDynamicsWorld, everything on the calling thread */
+        Discrete,
+        /* btDiscreteDynamicsWorldMt, islands solved in parallel by a pool of
+           solvers on the Bullet task scheduler */
+        DiscreteMt,
+    };
+
+    enum class PhysicsSolver {
+        SequentialImpulse,
+        SequentialImpulseSimd,
+        NonlinearConjugateGradient,
+    };
+
+    enum class PhysicsTaskScheduler {
+        Sequential,
+        /* Bullet's own std::thread based pool */
+        StdThread,
+        /* Only available if Bullet was built with BT_USE_OPENMP */
+        OpenMP,
+    };
+
+    struct PhysicsConfiguration {
+        PhysicsBackend backend = PhysicsBackend::Discrete;
+        PhysicsSolver solver = PhysicsSolver::SequentialImpulseSimd;
+        PhysicsTaskScheduler taskScheduler = PhysicsTaskScheduler::StdThread;
+        /* Worker threads for the task scheduler, 0 to keep its default */
+        Int threadCount = 0;
+        LevelCollisionMode levelCollision = LevelCollisionMode::ConvexHulls;
+        /* Per-frame PhysicsProfiler CSV, none if empty */
+        Containers::String profileCsvPath;
+
+        /* Reads the --physics-backend, --physics-solver, --physics-scheduler,
+           --physics-threads, --physics-level-collision and
+           --physics-profile-csv command-line options, ignoring all others */
+        static PhysicsConfiguration fromArguments(int argc, const char* const* argv);
+
+        /* Parse the command-line spelling of the options, returning false for unknown names */
+        bool setBackend(Containers::StringView name);
+        bool setSolver(Containers::StringView name);
+        bool setTaskScheduler(Containers::StringView name);
+        bool setLevelCollision(Containers::StringView name);
+    };
+
+    /**
+     * @brief Bullet world stepped on a fixed simulation tick
+     *
+     * Holds no GL state, so it's shared between the game and the headless
+     * simulation.
+     */
+    class PhysicsWorld {
+    public:
+        /* Simulation ticks per second, physics and player logic always step by
+           exactly 1/TickRate */
+        inline static Float TickRate = 60.0f;
+        /* Cap on ticks run in one frame to catch up, any backlog beyond that is
+           dropped instead of making the next frame slower still */
+        inline static Int MaxTicksPerFrame = 4;
+
+        /* Configuration used by worlds constructed without one, such as the game's */
+        inline static PhysicsConfiguration DefaultConfiguration{};
+
+        explicit PhysicsWorld(): PhysicsWorld{DefaultConfiguration} {}
+        explicit PhysicsWorld(const PhysicsConfiguration& configuration);
+        ~PhysicsWorld();
+
+        DISALLOW_COPY(PhysicsWorld)
+
+        btDiscreteDynamicsWorld& getWorld() { return *_bWorld; }
+
+        const PhysicsConfiguration& getConfiguration() const { return _configuration; }
+
+        static Float getTickDuration() { return 1.0f / Math::max(TickRate, 1.0f); }
+
+        /**
+         * @brief Accumulates frame time and runs as many whole ticks as are due
+         *
+         * @p preTick is called with the tick duration before each step, for
+         * game logic that has to run at the simulation rate. Returns the number
+         * of ticks run.
+         */
+        Int advance(Float frameDuration, const std::function<void(Float)>& preTick);
+
+        /* Runs exactly one simulation step and records the resulting poses */
+        void tick(Float tickDuration);
+
+        /* Fraction of a tick the accumulator is ahead of the last step */
+        Float getTickInterpolation() const { return _tickAccumulator / getTickDuration(); }
+
+        void interpolateDynamicBodies(Float alpha);
+
+        UnsignedLong getTickCount() const { return _tickCount; }
+
+        const GroundContacts& getGroundContacts() const { return _groundContacts; }
+
+        /* advance() ends a profiler frame by itself, callers of tick() have to
+           do that themselves */
+        PhysicsProfiler& getProfiler() { return _profiler; }
+        const PhysicsProfiler& getProfiler() const { return _profiler; }
+
+        /* Saves every dynamic body and the tick state, leaving the snapshot's
+           players alone */
+        void saveSnapshot(PhysicsSnapshot& snapshot) const;
+
+        /**
+         * @brief Puts every dynamic body back into the saved state
+         *
+         * Also drops the cached contact points, so the next tick doesn't
+         * warm-start from contacts of the abandoned future. Re-simulating
+         * from a restore therefore starts without warm starting and can
+         * drift slightly from the run the snapshot was taken in. Returns false
+         * without changing anything if the dynamic bodies in the world don't
+         * match the snapshot.
+         */
+        bool restoreSnapshot(const PhysicsSnapshot& snapshot);
+
+    private:
+        static Containers::Pointer<btConstraintSolver> createSolver(PhysicsSolver solver);
+
+        void setupTaskScheduler();
+
+        PhysicsConfiguration _configuration;
+
+        btDbvtBroadphase _bBroadphase;
+        btDefaultCollisionConfiguration _bCollisionConfig;
+        Containers::Pointer<btCollisionDispatcher> _bDispatcher;
+        Containers::Pointer<btConstraintSolver> _bSolver;
+        Containers::Array<Containers::Pointer<btConstraintSolver>> _bPoolSolvers;
+        Containers::Pointer<btConstraintSolverPoolMt> _bSolverPool;
+
+        /* The world has to live longer than the scene because RigidBody
+           instances have to remove themselves from it on destruction */
+        Containers::Pointer<btDiscreteDynamicsWorld> _bWorld;
+
+        GroundContacts _groundContacts;
+        PhysicsProfiler _profiler;
+
+        Float _tickAccumulator{};
+        UnsignedLong _tickCount{};
+    };
+}
@@ -5,16 +5,21 @@
 #include <Magnum/BulletIntegration/Integration.h>
 #include "Player.h"
 
-#include "OnGroundQuery.h"
-#include "TexturedDrawable.h"
+#include "IAnimatable.h"
+#include "IEnableDrawable.h"
 #include "RigidBody.h"
 
 namespace MagnumGame {
 
 
 
-    Player::Player(const std::string &name, RigidBody *pBody, Animator *animator)
+    Player::Player(const std::string &name, RigidBody *pBody, IAnimatable *animator)
         : _name(name), _pBody(pBody), _animator(animator), _pBodyDrawable{} {
+        auto& rb = _pBody->rigidBody();
+        //Prevent rotation in X & Z
+        rb.setAngularFactor(btVector3(0.0f, 0.0f, 0.0f));
+        rb.setFriction(0.5f);
+        rb.setRollingFriction(0.5f);
     }
 
     void Player::resetToStart(const Matrix4 &transformation) {
@@ -38,16 +43,20 @@ namespace MagnumGame {
         rigidBody.setLinearVelocity(btVector3(velocity));
 
         if (!_control.isZero()) {
-            auto position = _pBody->transformation().translation();
+            /* The Magnum-side transformation is interpolated for rendering, so
+               take the position from the simulation */
+            auto position = Vector3{rigidBody.getWorldTransform().getOrigin()};
             auto matrix = Matrix4::lookAt({0,0,0}, -_control, {0,1,0});
             matrix.translation() = position;
             _pBody->setTransformation(matrix);
+            /* Also wakes the body if it went to sleep standing still */
             _pBody->syncPose();
         }
 
-        _isOnGround = OnGroundQueryResult{rigidBody}.run(_pBody->getWorld());
+        /* Updated by GroundContacts after the previous tick */
+        _isOnGround = _pBody->isOnGround();
         if (_markJumpFrame && _isOnGround) {
-            rigidBody.applyImpulse({0,4.0f,0},{});
+            _pBody->applyImpulse({0,4.0f,0});
         }
         _markJumpFrame = false;
 
@@ -109,6 +118,18 @@ namespace MagnumGame {
         return _pBody->getWorld();
     }
 
+    void Player::saveState(PhysicsSnapshot::Player &state) const {
+        state.control = _control;
+        state.jumpQueued = _markJumpFrame;
+        state.onGround = _isOnGround;
+    }
+
+    void Player::restoreState(const PhysicsSnapshot::Player &state) {
+        _control = state.control;
+        _markJumpFrame = state.jumpQueued;
+        _isOnGround = state.onGround;
+    }
+
     void Player::tryJump() {
 
         _markJumpFrame = true;
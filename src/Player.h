@@ -4,12 +4,15 @@
 
 #pragma once
 
+#include <string>
 #include <BulletDynamics/Dynamics/btDynamicsWorld.h>
-#include "TexturedDrawable.h"
+#include "MagnumGameCommon.h"
+#include "PhysicsSnapshot.h"
 
 namespace MagnumGame {
     class UnlitAlphaDrawable;
     class IEnableDrawable;
+    class IAnimatable;
     class RigidBody;
 
     /**
@@ -21,7 +24,10 @@ namespace MagnumGame {
 
         inline static Float WalkSpeed = 4.0f;
 
-        Player(const std::string &name, RigidBody *pBody, Animator* animator);
+        static constexpr Float CapsuleRadius = 0.125f;
+        static constexpr Float CapsuleHeight = 0.5f;
+
+        Player(const std::string &name, RigidBody *pBody, IAnimatable* animator);
 
         void update(Float deltaTime);
 
@@ -49,14 +55,18 @@ namespace MagnumGame {
 
         bool isOnGround() const { return _isOnGround; }
 
+        /* Input and ground state, the body itself is in the physics snapshot */
+        void saveState(PhysicsSnapshot::Player& state) const;
+        void restoreState(const PhysicsSnapshot::Player& state);
+
     private:
         std::string _name;
         RigidBody *_pBody;
-        Animator *_animator;
+        IAnimatable *_animator;
         IEnableDrawable *_pBodyDrawable{};
         Vector3 _control{};
-        bool _markJumpFrame;
-        bool _isOnGround;
+        bool _markJumpFrame{};
+        bool _isOnGround{};
     };
 
 }
@@ -0,0 +1,37 @@
+#include "PoseCache.h"
+
+#include <cmath>
+
+#include "AnimationState.h"
+
+namespace MagnumGame {
+
+    PoseCache::Lookup PoseCache::lookup(AnimationState &state, const std::function<UnsignedInt(UnsignedInt)> &allocate) {
+        const AnimationClip* clip = state.getClip();
+        CORRADE_INTERNAL_ASSERT(clip);
+
+        /* The time is wrapped to the clip length already, the last step may
+           be shorter than the others */
+        const auto step = UnsignedInt(std::floor(state.getTime() * StepsPerSecond));
+        const Float time = Float(step) / StepsPerSecond;
+
+        const Key key{clip, step};
+        auto found = _entries.find(key);
+        if (found != _entries.end()) {
+            _frameHits++;
+            return {found->second, true, time};
+        }
+
+        _frameMisses++;
+        if (_entries.size() >= MaxEntries) return {{}, false, time};
+
+        Containers::Array<UnsignedInt> jointOffsets{NoInit, state.getSkinCount()};
+        for (std::size_t skin = 0; skin < state.getSkinCount(); skin++) {
+            const auto jointCount = UnsignedInt(state.getSkin(skin).boneMatrices().size());
+            jointOffsets[skin] = allocate(jointCount);
+            _matrixCount += jointCount;
+        }
+        auto& entry = _entries.emplace(key, std::move(jointOffsets)).first->second;
+        return {entry, false, time};
+    }
+}
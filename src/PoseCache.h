@@ -0,0 +1,72 @@
+#pragma once
+
+#include <functional>
+#include <map>
+#include <utility>
+#include <Corrade/Containers/Array.h>
+#include <Corrade/Containers/ArrayView.h>
+
+#include "MagnumGameCommon.h"
+
+namespace MagnumGame {
+    class AnimationClip;
+    class AnimationState;
+
+    /**
+     * @brief Joint matrices shared by characters showing the same pose
+     *
+     * Clip time is quantized to StepsPerSecond steps. The first character
+     * to reach a step of a clip samples it at the time of the step into a
+     * range of joint matrices kept for it, always with the whole skeleton
+     * even if the character itself only needs reduced bones. Every other
+     * character reaching that step later just points its skins at the same
+     * range. A step of a clip always produces the same pose, so entries are
+     * never updated or evicted, and a character skipping frames can keep
+     * pointing at one.
+     * The clip pointer stands for the asset too, each asset has its own.
+     * Holds no GL state, the ranges come from the allocator given.
+     */
+    class PoseCache {
+    public:
+        /* 0 disables the cache. Read when looking up */
+        inline static Float StepsPerSecond = 30.0f;
+        /* Characters sample their own pose once this many are cached */
+        inline static std::size_t MaxEntries = 1024;
+
+        struct Lookup {
+            /* Joint matrix offset of every skin, empty if the cache is full */
+            Containers::ArrayView<const UnsignedInt> jointOffsets;
+            /* False if the caller has to sample the pose into jointOffsets */
+            bool hit;
+            /* Clip time of the step */
+            Float time;
+        };
+
+        explicit PoseCache() = default;
+
+        DISALLOW_COPY(PoseCache)
+
+        /* Finds the entry for the current time of @p state, adding one with
+           ranges from @p allocate, called with the joint count of each skin,
+           if there's none yet. @p state has to be playing a clip */
+        Lookup lookup(AnimationState& state, const std::function<UnsignedInt(UnsignedInt)>& allocate);
+
+        /* Starts counting the hits and misses of a new frame */
+        void resetFrameCounts() { _frameHits = _frameMisses = 0; }
+
+        UnsignedInt getFrameHits() const { return _frameHits; }
+        UnsignedInt getFrameMisses() const { return _frameMisses; }
+        std::size_t getEntryCount() const { return _entries.size(); }
+
+        /* Joint matrices of every entry */
+        std::size_t getMatrixCount() const { return _matrixCount; }
+
+    private:
+        using Key = std::pair<const AnimationClip*, UnsignedInt>;
+
+        std::map<Key, Containers::Array<UnsignedInt>> _entries;
+        std::size_t _matrixCount{};
+        UnsignedInt _frameHits{};
+        UnsignedInt _frameMisses{};
+    };
+}
@@ -0,0 +1,89 @@
+#include "RenderQueue.h"
+
+#include <algorithm>
+#include <sstream>
+#include <Corrade/Containers/GrowableArray.h>
+#include <Magnum/GL/AbstractShaderProgram.h>
+#include <Magnum/GL/Mesh.h>
+#include <Magnum/GL/Texture.h>
+#include <Magnum/Math/Frustum.h>
+#include <Magnum/Math/Intersection.h>
+#include <Magnum/SceneGraph/Camera.h>
+
+#include "SceneBvh.h"
+#include "TexturedDrawable.h"
+
+namespace MagnumGame {
+
+    UnsignedLong RenderQueue::makeKey(const TexturedDrawable &drawable, const Matrix4 &transformation) {
+        const GL::AbstractShaderProgram* shader = &drawable.getShader();
+        std::size_t shaderIndex = 0;
+        while (shaderIndex < _shaders.size() && _shaders[shaderIndex] != shader) shaderIndex++;
+        if (shaderIndex == _shaders.size()) arrayAppend(_shaders, shader);
+
+        /* 8 bits of shader, 20 of texture and mesh ids, 16 of depth. Ids
+           beyond 20 bits only make the sort less tight, not wrong */
+        const UnsignedLong texture = drawable.getTexture() ? drawable.getTexture()->id() : 0;
+        const UnsignedLong mesh = drawable.getMesh().id();
+        const Float depth = Math::clamp(-transformation.translation().z() / MaxSortDepth, 0.0f, 1.0f);
+        if (_order == RenderOrder::BackToFront) return UnsignedLong((1.0f - depth) * 65535.0f);
+        return (UnsignedLong(Math::min<std::size_t>(shaderIndex, 0xff)) << 56)
+             | ((texture & 0xfffff) << 36)
+             | ((mesh & 0xfffff) << 16)
+             | UnsignedLong(depth * 65535.0f);
+    }
+
+    void RenderQueue::add(TexturedDrawable &drawable, const Matrix4 &transformation, const Frustum &frustum) {
+        if (!drawable.isVisible()) return;
+        if (drawable.hasBounds() && !Math::Intersection::rangeFrustum(SceneBvh::transformBounds(transformation, drawable.getBounds()), frustum)) {
+            _state.culled++;
+            return;
+        }
+        arrayAppend(_items, InPlaceInit, makeKey(drawable, transformation), &drawable, transformation);
+    }
+
+    void RenderQueue::submitSorted(SceneGraph::Camera3D &camera) {
+        std::sort(_items.begin(), _items.end(), [](const Item& a, const Item& b) { return a.key < b.key; });
+
+        for (auto& item : _items) {
+            item.drawable->submit(item.transformation, camera, _state);
+        }
+    }
+
+    void RenderQueue::draw(SceneGraph::DrawableGroup3D &drawables, SceneGraph::Camera3D &camera) {
+        auto transformations = camera.drawableTransformations(drawables);
+        /* The transformations are relative to the camera already */
+        const Frustum frustum = Frustum::fromMatrix(camera.projectionMatrix());
+
+        _state = {};
+        arrayResize(_items, NoInit, 0);
+        arrayReserve(_items, transformations.size());
+        for (auto& [drawable, transformation] : transformations) {
+            add(static_cast<TexturedDrawable&>(drawable.get()), transformation, frustum);
+        }
+        submitSorted(camera);
+    }
+
+    void RenderQueue::draw(Containers::ArrayView<TexturedDrawable* const> drawables, SceneGraph::Camera3D &camera) {
+        const Frustum frustum = Frustum::fromMatrix(camera.projectionMatrix());
+        const Matrix4 cameraMatrix = camera.cameraMatrix();
+
+        _state = {};
+        arrayResize(_items, NoInit, 0);
+        arrayReserve(_items, drawables.size());
+        for (auto* drawable : drawables) {
+            add(*drawable, cameraMatrix * drawable->getObject3D().absoluteTransformationMatrix(), frustum);
+        }
+        submitSorted(camera);
+    }
+
+    std::string RenderQueue::getSummary() const {
+        std::ostringstream out;
+        out << "Draws: " << _state.draws << ", " << _state.culled << " culled"
+            << "\nShader changes: " << _state.shaderChanges
+            << "\nTexture binds: " << _state.textureBinds
+            << "\nMesh changes: " << _state.meshChanges
+            << "\nSkipped state changes: " << _state.skippedChanges;
+        return out.str();
+    }
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <string>
+#include <Corrade/Containers/Array.h>
+#include <Corrade/Containers/ArrayView.h>
+#include <Magnum/GL/GL.h>
+#include <Magnum/Math/Matrix4.h>
+#include <Magnum/SceneGraph/SceneGraph.h>
+
+#include "MagnumGameCommon.h"
+
+namespace MagnumGame {
+    class TexturedDrawable;
+
+    /* What was last set up for drawing, so TexturedDrawable::submit() can
+       skip setting it again, and how often it changed */
+    struct RenderState {
+        /* Shader whose per-frame uniforms are set */
+        const GL::AbstractShaderProgram* shader{};
+        GL::Texture2D* texture{};
+        GL::Mesh* mesh{};
+        /* -1 while unknown for the current shader */
+        Int perVertexJointCount{-1};
+
+        UnsignedInt draws{};
+        UnsignedInt shaderChanges{};
+        UnsignedInt textureBinds{};
+        UnsignedInt meshChanges{};
+        /* Texture binds and per-frame or joint count uniforms not repeated */
+        UnsignedInt skippedChanges{};
+        /* Outside of the camera frustum, not drawn */
+        UnsignedInt culled{};
+    };
+
+    enum class RenderOrder {
+        /* By shader, texture, mesh, then nearest first */
+        State,
+        /* Farthest first, for blending */
+        BackToFront,
+    };
+
+    /**
+     * @brief Draws a group of TexturedDrawable instances sorted by state
+     *
+     * Every frame each drawable gets a key of its shader, texture, mesh and
+     * depth in front of the camera, so draws sharing a shader are together,
+     * within those draws sharing a texture and then a mesh, nearest first.
+     * The per-frame uniforms of a shader are set once at its first draw and
+     * textures are only bound when they change. Drawables with bounds are
+     * left out if the box around their bounds moved to the camera is
+     * outside of its frustum.
+     */
+    class RenderQueue {
+    public:
+        /* Depths beyond it sort as the same */
+        inline static Float MaxSortDepth = 200.0f;
+
+        explicit RenderQueue(RenderOrder order = RenderOrder::State): _order{order} {}
+
+        DISALLOW_COPY(RenderQueue)
+
+        /* @p drawables has to contain only TexturedDrawable instances */
+        void draw(SceneGraph::DrawableGroup3D& drawables, SceneGraph::Camera3D& camera);
+
+        /* Draws only @p drawables, candidates a SceneBvh query found, still
+           culling each against its own bounds */
+        void draw(Containers::ArrayView<TexturedDrawable* const> drawables, SceneGraph::Camera3D& camera);
+
+        /* Counts of the last draw() */
+        const RenderState& getLastState() const { return _state; }
+
+        std::string getSummary() const;
+
+    private:
+        struct Item {
+            UnsignedLong key;
+            TexturedDrawable* drawable;
+            Matrix4 transformation;
+        };
+
+        UnsignedLong makeKey(const TexturedDrawable& drawable, const Matrix4& transformation);
+        /* Queues @p drawable unless it's hidden or outside of @p frustum */
+        void add(TexturedDrawable& drawable, const Matrix4& transformation, const Frustum& frustum);
+        void submitSorted(SceneGraph::Camera3D& camera);
+
+        RenderOrder _order;
+        Containers::Array<Item> _items;
+        /* Small indices for the sort key, in order of first appearance */
+        Containers::Array<const GL::AbstractShaderProgram*> _shaders;
+        RenderState _state;
+    };
+}
@@ -9,21 +9,27 @@
 namespace MagnumGame {
 
     RigidBody::RigidBody(Float mass, btCollisionShape *bShape, btDynamicsWorld &bWorld, CollisionLayer layer): Object3D{nullptr},
-        _bWorld(bWorld) {
+        _bWorld(bWorld), _layer(layer) {
         /* Calculate inertia so the object reacts as it should with
                rotation and everything */
         btVector3 bInertia(0.0f, 0.0f, 0.0f);
         if (!Math::TypeTraits<Float>::equals(mass, 0.0f))
             bShape->calculateLocalInertia(mass, bInertia);
 
-        //motionState is allocated here and added as a feature to this RigidBody, so deleted by it.
-        auto motionState = new BulletIntegration::MotionState(*this);
-        //It would be nice to do this: but it doesn't work because of addFeature being in AbstractObject and the MotionState template constructor requiring a transformation
-        // auto& motionState = addFeature<BulletIntegration::MotionState>();
+        /* Static bodies never move, so they go in without a motion state and
+           Bullet marks them CF_STATIC_OBJECT */
+        btMotionState* bMotionState = nullptr;
+        if (!Math::TypeTraits<Float>::equals(mass, 0.0f)) {
+            //motionState is allocated here and added as a feature to this RigidBody, so deleted by it.
+            auto motionState = new BulletIntegration::MotionState(*this);
+            //It would be nice to do this: but it doesn't work because of addFeature being in AbstractObject and the MotionState template constructor requiring a transformation
+            // auto& motionState = addFeature<BulletIntegration::MotionState>();
+            bMotionState = &motionState->btMotionState();
+        }
         _bRigidBody.emplace(btRigidBody::btRigidBodyConstructionInfo{
-            mass, &motionState->btMotionState(), bShape, bInertia});
-        _bRigidBody->forceActivationState(DISABLE_DEACTIVATION);
-        bWorld.addRigidBody(_bRigidBody.get(), getLayerGroupMask(layer), getLayerCollisionMask(layer));
+            mass, bMotionState, bShape, bInertia});
+        _bRigidBody->setUserPointer(this);
+        addToWorld();
     }
 
     RigidBody::~RigidBody() {
@@ -31,11 +37,58 @@ namespace MagnumGame {
     }
 
     void RigidBody::syncPose() {
-        _bRigidBody->setWorldTransform(btTransform(transformationMatrix()));
+        auto matrix = transformationMatrix();
+        _bRigidBody->setWorldTransform(btTransform(matrix));
+
+        if (_bRigidBody->isStaticOrKinematicObject()) {
+            /* The world only recomputes AABBs of active bodies each step */
+            if (_bRigidBody->getBroadphaseHandle()) _bWorld.updateSingleAabb(_bRigidBody.get());
+            return;
+        }
+
+        /* A pose set from the Magnum side is a teleport, wake the body so the
+           world notices and don't interpolate into it */
+        wake();
+        _previousTickPosition = _currentTickPosition = matrix.translation();
+        _previousTickRotation = _currentTickRotation = Quaternion::fromMatrix(matrix.rotation());
+    }
+
+    void RigidBody::restorePose(const Vector3& position, const Quaternion& rotation) {
+        btTransform transform{btQuaternion{rotation}, btVector3{position}};
+        _bRigidBody->setWorldTransform(transform);
+        _bRigidBody->setInterpolationWorldTransform(transform);
+
+        _previousTickPosition = _currentTickPosition = position;
+        _previousTickRotation = _currentTickRotation = rotation;
+        setTransformation(Matrix4::from(rotation.toMatrix(), position));
+    }
+
+    void RigidBody::captureTickPose() {
+        auto& worldTransform = _bRigidBody->getWorldTransform();
+        _previousTickPosition = _currentTickPosition;
+        _previousTickRotation = _currentTickRotation;
+        _currentTickPosition = Vector3{worldTransform.getOrigin()};
+        _currentTickRotation = Quaternion{worldTransform.getRotation()};
+    }
+
+    void RigidBody::interpolateTickPose(Float alpha) {
+        auto rotation = Math::slerpShortestPath(_previousTickRotation, _currentTickRotation, alpha);
+        auto position = Math::lerp(_previousTickPosition, _currentTickPosition, alpha);
+        setTransformation(Matrix4::from(rotation.toMatrix(), position));
     }
 
     void RigidBody::addToWorld() {
-        _bWorld.addRigidBody(_bRigidBody.get());
+        _bWorld.addRigidBody(_bRigidBody.get(), getLayerGroupMask(_layer), getLayerCollisionMask(_layer));
+        wake();
+    }
+
+    void RigidBody::wake() {
+        if (!_bRigidBody->isStaticOrKinematicObject()) _bRigidBody->activate();
+    }
+
+    void RigidBody::applyImpulse(const Vector3& impulse, const Vector3& relativePosition) {
+        wake();
+        _bRigidBody->applyImpulse(btVector3{impulse}, btVector3{relativePosition});
     }
 
     void RigidBody::removeFromWorld() {
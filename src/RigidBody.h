@@ -6,6 +6,7 @@
 
 #include <btBulletDynamicsCommon.h>
 #include <Corrade/Containers/Pointer.h>
+#include <Magnum/Math/Quaternion.h>
 #include "MagnumGameCommon.h"
 
 namespace MagnumGame {
@@ -46,13 +47,44 @@ namespace MagnumGame {
 
         btDynamicsWorld& getWorld() { return _bWorld; };
 
+        /* Re-adds the body with the group and mask of its layer */
         void addToWorld();
         void removeFromWorld();
 
+        /* Dynamic bodies are allowed to sleep, anything that moves them from
+           outside the simulation has to wake them first */
+        void wake();
+        void applyImpulse(const Vector3& impulse, const Vector3& relativePosition = {});
+
+        /* Records the Bullet pose after a fixed simulation tick, keeping the
+           previous one for render interpolation */
+        void captureTickPose();
+
+        /* Sets the Magnum-side transformation between the last two captured
+           tick poses, alpha being 0 at the previous and 1 at the current tick */
+        void interpolateTickPose(Float alpha);
+
+        /* Sets the Bullet and Magnum pose at once without interpolating into
+           it, for restoring snapshots */
+        void restorePose(const Vector3& position, const Quaternion& rotation);
+
+        /* Touching static ground below the origin after the last tick, see
+           GroundContacts */
+        bool isOnGround() const { return _onGround; }
+        void setOnGround(bool onGround) { _onGround = onGround; }
+
+        static RigidBody* fromCollisionObject(const btCollisionObject* object) {
+            return static_cast<RigidBody*>(object->getUserPointer());
+        }
 
     private:
         btDynamicsWorld &_bWorld;
+        CollisionLayer _layer;
         Containers::Pointer<btRigidBody> _bRigidBody;
+
+        Vector3 _previousTickPosition{}, _currentTickPosition{};
+        Quaternion _previousTickRotation{}, _currentTickRotation{};
+        bool _onGround{};
     };
 
 }
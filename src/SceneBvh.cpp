@@ -0,0 +1,127 @@
+#include "SceneBvh.h"
+
+#include <cstdint>
+#include <Corrade/Containers/GrowableArray.h>
+#include <Corrade/Utility/Assert.h>
+#include <Magnum/BulletIntegration/Integration.h>
+
+namespace MagnumGame {
+
+    namespace {
+        btDbvtVolume toVolume(const Range3D& bounds) {
+            return btDbvtVolume::FromMM(btVector3{bounds.min()}, btVector3{bounds.max()});
+        }
+
+        /* Appends the id of every leaf it's called for */
+        struct CollectIds : btDbvt::ICollide {
+            explicit CollectIds(Containers::Array<UnsignedInt>& ids): ids{ids} {}
+
+            using btDbvt::ICollide::Process;
+            void Process(const btDbvtNode* leaf) override {
+                arrayAppend(ids, UnsignedInt(reinterpret_cast<std::uintptr_t>(leaf->data)));
+            }
+
+            Containers::Array<UnsignedInt>& ids;
+        };
+
+        /* The tree only knows boxes, drops the leaves whose box is only
+           inside the box around the sphere */
+        struct CollectIdsInSphere : CollectIds {
+            explicit CollectIdsInSphere(Containers::Array<UnsignedInt>& ids, const Vector3& center, Float radius):
+                CollectIds{ids}, center{center}, radius{radius} {}
+
+            using CollectIds::Process;
+            void Process(const btDbvtNode* leaf) override {
+                const Vector3 closest = Math::clamp(center, Vector3{leaf->volume.Mins()}, Vector3{leaf->volume.Maxs()});
+                if ((closest - center).dot() <= radius*radius) CollectIds::Process(leaf);
+            }
+
+            Vector3 center;
+            Float radius;
+        };
+    }
+
+    SceneBvh::Handle SceneBvh::insert(const Range3D &bounds, UnsignedInt id) {
+        return _tree.insert(toVolume(bounds.padded(Vector3{Margin})), reinterpret_cast<void*>(std::uintptr_t(id)));
+    }
+
+    bool SceneBvh::update(Handle handle, const Range3D &bounds) {
+        auto volume = toVolume(bounds);
+        return _tree.update(handle, volume, Margin);
+    }
+
+    void SceneBvh::remove(Handle handle) {
+        _tree.remove(handle);
+    }
+
+    Range3D SceneBvh::transformBounds(const Matrix4 &transformation, const Range3D &bounds) {
+        /* By the absolute rotation and scaling applied to the half size */
+        const Vector3 center = transformation.transformPoint(bounds.center());
+        const Matrix3x3 linear = transformation.rotationScaling();
+        const Vector3 halfSize = bounds.size() * 0.5f;
+        Vector3 extent;
+        for (std::size_t column = 0; column < 3; column++) {
+            extent += Math::abs(linear[column]) * halfSize[column];
+        }
+        return {center - extent, center + extent};
+    }
+
+    void SceneBvh::optimize() {
+        if (_tree.m_root) _tree.optimizeIncremental(OptimizePasses);
+    }
+
+    void SceneBvh::queryPlanes(Containers::ArrayView<const Vector4> planes, Containers::Array<UnsignedInt> &ids) const {
+        if (!_tree.m_root) return;
+
+        /* Like btDbvt::collideKDOP(), but with a stack kept between calls
+           instead of allocated by each. A node is only tested against the
+           planes its parent isn't fully in front of */
+        CORRADE_INTERNAL_ASSERT(planes.size() <= 8);
+        arrayResize(_planeStack, NoInit, 0);
+        arrayAppend(_planeStack, PlaneStackEntry{_tree.m_root, 0});
+        while (!_planeStack.isEmpty()) {
+            auto [node, inside] = _planeStack.back();
+            arrayRemoveSuffix(_planeStack);
+
+            const Vector3 min{node->volume.Mins()}, max{node->volume.Maxs()};
+            bool outside = false;
+            for (std::size_t i = 0; i < planes.size() && !outside; i++) {
+                if (inside & (1u << i)) continue;
+                const Vector3 normal = planes[i].xyz();
+                Vector3 farthest, nearest;
+                for (std::size_t axis = 0; axis < 3; axis++) {
+                    farthest[axis] = normal[axis] >= 0.0f ? max[axis] : min[axis];
+                    nearest[axis] = normal[axis] >= 0.0f ? min[axis] : max[axis];
+                }
+                if (Math::dot(normal, farthest) + planes[i].w() < 0.0f) outside = true;
+                else if (Math::dot(normal, nearest) + planes[i].w() >= 0.0f) inside |= UnsignedByte(1u << i);
+            }
+            if (outside) continue;
+
+            if (node->isleaf()) {
+                arrayAppend(ids, UnsignedInt(reinterpret_cast<std::uintptr_t>(node->data)));
+            } else {
+                arrayAppend(_planeStack, PlaneStackEntry{node->childs[0], inside});
+                arrayAppend(_planeStack, PlaneStackEntry{node->childs[1], inside});
+            }
+        }
+    }
+
+    void SceneBvh::queryFrustum(const Frustum &frustum, Containers::Array<UnsignedInt> &ids) const {
+        queryPlanes({frustum.begin(), 6}, ids);
+    }
+
+    void SceneBvh::querySphere(const Vector3 &center, Float radius, Containers::Array<UnsignedInt> &ids) const {
+        if (!_tree.m_root) return;
+
+        CollectIdsInSphere collect{ids, center, radius};
+        _tree.collideTV(_tree.m_root, toVolume(Range3D::fromCenter(center, Vector3{radius})), collect);
+    }
+
+    void SceneBvh::queryRay(const Vector3 &from, const Vector3 &to, Containers::Array<UnsignedInt> &ids) const {
+        if (!_tree.m_root) return;
+
+        CollectIds collect{ids};
+        btDbvt::rayTest(_tree.m_root, btVector3{from}, btVector3{to}, collect);
+    }
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <BulletCollision/BroadphaseCollision/btDbvt.h>
+#include <Corrade/Containers/Array.h>
+#include <Corrade/Containers/ArrayView.h>
+#include <Magnum/Math/Frustum.h>
+#include <Magnum/Math/Matrix4.h>
+#include <Magnum/Math/Range.h>
+
+#include "MagnumGameCommon.h"
+
+namespace MagnumGame {
+
+    /**
+     * @brief Dynamic bounding volume tree of world space boxes for visibility
+     *
+     * A btDbvt, the same tree Bullet's broadphase uses, with an id per leaf.
+     * Leaves are stored grown by Margin, so update() only refits the tree
+     * once an object moved out of that, and incrementally optimized a few
+     * passes per frame. Queries append the ids of every leaf whose box may
+     * intersect the frustum, sphere or ray, callers test their exact bounds
+     * on those only. Holds no GL state.
+     */
+    class SceneBvh {
+    public:
+        using Handle = btDbvtNode*;
+
+        /* Grown on every side of the bounds of a leaf */
+        inline static Float Margin = 0.2f;
+        /* Tree optimization passes run by optimize() */
+        inline static Int OptimizePasses = 2;
+
+        explicit SceneBvh() = default;
+
+        DISALLOW_COPY(SceneBvh)
+
+        Handle insert(const Range3D& bounds, UnsignedInt id);
+
+        /* Refits the tree if @p bounds are outside of the leaf, returns
+           whether it did */
+        bool update(Handle handle, const Range3D& bounds);
+
+        void remove(Handle handle);
+
+        /* Once a frame, after the updates */
+        void optimize();
+
+        std::size_t getLeafCount() const { return std::size_t(_tree.m_leaves); }
+
+        /* Box around @p bounds after @p transformation */
+        static Range3D transformBounds(const Matrix4& transformation, const Range3D& bounds);
+
+        /* Leaves in front of all @p planes, at most eight, a Frustum or a
+           subset of its planes as in Magnum's Frustum, the normal pointing
+           inside. Doesn't allocate once its stack and @p ids grew enough */
+        void queryPlanes(Containers::ArrayView<const Vector4> planes, Containers::Array<UnsignedInt>& ids) const;
+        void queryFrustum(const Frustum& frustum, Containers::Array<UnsignedInt>& ids) const;
+
+        void querySphere(const Vector3& center, Float radius, Containers::Array<UnsignedInt>& ids) const;
+
+        /* Leaves crossed by the segment from @p from to @p to */
+        void queryRay(const Vector3& from, const Vector3& to, Containers::Array<UnsignedInt>& ids) const;
+
+    private:
+        struct PlaneStackEntry {
+            const btDbvtNode* node;
+            /* Bit per plane the node is fully in front of */
+            UnsignedByte inside;
+        };
+
+        btDbvt _tree;
+        /* Reused by queryPlanes() */
+        mutable Containers::Array<PlaneStackEntry> _planeStack;
+    };
+}
@@ -0,0 +1,227 @@
+#include "SceneBvhBenchmark.h"
+
+#include <chrono>
+#include <new>
+#include <random>
+#include <utility>
+#include <Corrade/Containers/Array.h>
+#include <Corrade/Containers/ArrayView.h>
+#include <Corrade/Containers/GrowableArray.h>
+#include <Magnum/Math/Frustum.h>
+#include <Magnum/Math/Functions.h>
+#include <Magnum/Math/Matrix4.h>
+
+#include "SceneBvh.h"
+
+namespace MagnumGame {
+
+    namespace {
+        typedef std::chrono::duration<double, std::milli> Milliseconds;
+
+        struct BenchmarkObject {
+            Range3D localBounds;
+            Matrix4 transformation;
+            /* Zero for static objects */
+            Vector3 velocity;
+            Range3D worldBounds;
+            SceneBvh::Handle handle;
+        };
+
+        /* Whether @p box is in front of all @p planes, by its corner farthest
+           along each normal, the same test the tree does */
+        bool isInside(const Range3D& box, Containers::ArrayView<const Vector4> planes) {
+            for (auto& plane : planes) {
+                Vector3 corner;
+                for (std::size_t i = 0; i < 3; i++) corner[i] = plane[i] >= 0.0f ? box.max()[i] : box.min()[i];
+                if (Math::dot(plane.xyz(), corner) + plane.w() < 0.0f) return false;
+            }
+            return true;
+        }
+
+        bool sphereHits(const Vector3& center, Float radius, const Range3D& box) {
+            return (Math::clamp(center, box.min(), box.max()) - center).dot() <= radius*radius;
+        }
+
+        bool segmentHits(const Vector3& from, const Vector3& to, const Range3D& box) {
+            const Vector3 direction = to - from;
+            Float near = 0.0f, far = 1.0f;
+            for (std::size_t i = 0; i < 3; i++) {
+                if (Math::abs(direction[i]) < 1.0e-6f) {
+                    if (from[i] < box.min()[i] || from[i] > box.max()[i]) return false;
+                    continue;
+                }
+                Float t0 = (box.min()[i] - from[i]) / direction[i];
+                Float t1 = (box.max()[i] - from[i]) / direction[i];
+                if (t0 > t1) std::swap(t0, t1);
+                near = Math::max(near, t0);
+                far = Math::min(far, t1);
+                if (near > far) return false;
+            }
+            return true;
+        }
+    }
+
+    SceneBvhBenchmark::Result SceneBvhBenchmark::run(UnsignedInt objectCount, UnsignedInt frameCount) {
+        /* Deterministic, so runs are comparable */
+        std::mt19937 random{0};
+        std::uniform_real_distribution<Float> unit{0.0f, 1.0f};
+
+        /* About one box every 2x2 units */
+        const Float side = 2.0f * Math::sqrt(Float(objectCount));
+        const Range2D area{Vector2{-0.5f * side}, Vector2{0.5f * side}};
+
+        SceneBvh bvh;
+        Containers::Array<BenchmarkObject> objects{NoInit, objectCount};
+        for (UnsignedInt i = 0; i < objectCount; i++) {
+            const Vector3 halfSize{0.25f + 0.75f * unit(random), 0.25f + 0.75f * unit(random), 0.25f + 0.75f * unit(random)};
+            const Vector3 position{area.min().x() + side * unit(random), 4.0f * unit(random), area.min().y() + side * unit(random)};
+            auto& object = *new(&objects[i]) BenchmarkObject{
+                {-halfSize, halfSize},
+                Matrix4::translation(position) * Matrix4::rotationY(Rad{unit(random) * Constants::tau()}),
+                {},
+                {},
+                nullptr
+            };
+            if (unit(random) < DynamicFraction) {
+                object.velocity = Vector3{unit(random) - 0.5f, 0.0f, unit(random) - 0.5f} * 6.0f;
+            }
+            object.worldBounds = SceneBvh::transformBounds(object.transformation, object.localBounds);
+            object.handle = bvh.insert(object.worldBounds, i);
+        }
+
+        /* Like GameState: a perspective camera in the middle of the level and
+           orthographic cascades along a light, without their near plane */
+        const Matrix4 projection = Matrix4::perspectiveProjection(60.0_degf, 16.0f/9.0f, 0.1f, 128.0f);
+        const Vector3 lightDirection = Vector3{-1.0f, -2.0f, -0.5f}.normalized();
+        const Float cascadeSplits[]{8.0f, 20.0f, 50.0f, 128.0f};
+        constexpr std::size_t ViewCount = 1 + Containers::arraySize(cascadeSplits);
+
+        const Float frameDuration = 1.0f / 60.0f;
+        Milliseconds bruteForce{}, bvhTotal{}, refit{}, bruteForceSphere{}, bvhSphere{}, bruteForceRay{}, bvhRay{};
+        Result result{};
+        Containers::Array<UnsignedInt> ids;
+        for (UnsignedInt frame = 0; frame < frameCount; frame++) {
+            /* Move the dynamic objects, bouncing off the edges */
+            for (auto& object : objects) {
+                if (object.velocity.isZero()) continue;
+                Vector3 position = object.transformation.translation() + object.velocity * frameDuration;
+                for (std::size_t i : {0, 2}) {
+                    const std::size_t areaIndex = i / 2;
+                    if (position[i] < area.min()[areaIndex] || position[i] > area.max()[areaIndex]) object.velocity[i] = -object.velocity[i];
+                }
+                object.transformation.translation() = position;
+            }
+
+            const Matrix4 cameraObject = Matrix4::translation({0.0f, 2.0f, 0.0f}) * Matrix4::rotationY(Rad{Float(frame) * 0.01f});
+            const Frustum cameraFrustum = Frustum::fromMatrix(projection * cameraObject.invertedRigid());
+            Vector4 planes[ViewCount][6];
+            std::size_t planeCounts[ViewCount];
+            for (std::size_t i = 0; i < 6; i++) planes[0][i] = cameraFrustum[i];
+            planeCounts[0] = 6;
+            const Vector3 forward = -cameraObject.backward();
+            for (std::size_t cascade = 0; cascade < Containers::arraySize(cascadeSplits); cascade++) {
+                const Vector3 center = cameraObject.translation() + forward * (0.5f * cascadeSplits[cascade]);
+                const Matrix4 lightObject = Matrix4::lookAt(center, center + lightDirection, Vector3::yAxis());
+                const Frustum frustum = Frustum::fromMatrix(
+                    Matrix4::orthographicProjection(Vector2{1.2f * cascadeSplits[cascade]}, -100.0f, 100.0f) * lightObject.invertedRigid());
+                /* Left, right, bottom, top and far */
+                for (std::size_t i = 0; i < 4; i++) planes[1 + cascade][i] = frustum[i];
+                planes[1 + cascade][4] = frustum[5];
+                planeCounts[1 + cascade] = 5;
+            }
+
+            /* Every object's bounds transformed once, then tested against
+               every view */
+            UnsignedInt bruteForceVisible[ViewCount]{};
+            auto start = std::chrono::steady_clock::now();
+            for (auto& object : objects) {
+                object.worldBounds = SceneBvh::transformBounds(object.transformation, object.localBounds);
+            }
+            for (std::size_t view = 0; view < ViewCount; view++) {
+                const Containers::ArrayView<const Vector4> viewPlanes{planes[view], planeCounts[view]};
+                for (auto& object : objects) {
+                    if (isInside(object.worldBounds, viewPlanes)) bruteForceVisible[view]++;
+                }
+            }
+            bruteForce += std::chrono::steady_clock::now() - start;
+
+            /* Transform and refit what moved like GameState::refitSceneBvh(),
+               static bounds never change, then only test what the queries
+               return */
+            UnsignedInt bvhVisible[ViewCount]{};
+            start = std::chrono::steady_clock::now();
+            for (auto& object : objects) {
+                if (object.velocity.isZero()) continue;
+                object.worldBounds = SceneBvh::transformBounds(object.transformation, object.localBounds);
+                bvh.update(object.handle, object.worldBounds);
+            }
+            bvh.optimize();
+            const auto refitEnd = std::chrono::steady_clock::now();
+            refit += refitEnd - start;
+            for (std::size_t view = 0; view < ViewCount; view++) {
+                const Containers::ArrayView<const Vector4> viewPlanes{planes[view], planeCounts[view]};
+                arrayResize(ids, NoInit, 0);
+                bvh.queryPlanes(viewPlanes, ids);
+                result.averageCandidates += Double(ids.size());
+                for (auto id : ids) {
+                    if (isInside(objects[id].worldBounds, viewPlanes)) bvhVisible[view]++;
+                }
+            }
+            bvhTotal += std::chrono::steady_clock::now() - start;
+
+            for (std::size_t view = 0; view < ViewCount; view++) {
+                result.averageVisible += Double(bruteForceVisible[view]);
+                if (bvhVisible[view] != bruteForceVisible[view]) result.mismatches++;
+            }
+
+            for (UnsignedInt query = 0; query < QueriesPerFrame; query++) {
+                const Vector3 center{area.min().x() + side * unit(random), 1.0f, area.min().y() + side * unit(random)};
+                const Float radius = 5.0f;
+                const Vector3 to = center + Vector3{unit(random) - 0.5f, 0.0f, unit(random) - 0.5f} * 60.0f;
+
+                UnsignedInt bruteForceHits = 0, bvhHits = 0;
+                start = std::chrono::steady_clock::now();
+                for (auto& object : objects) {
+                    if (sphereHits(center, radius, object.worldBounds)) bruteForceHits++;
+                }
+                bruteForceSphere += std::chrono::steady_clock::now() - start;
+                start = std::chrono::steady_clock::now();
+                arrayResize(ids, NoInit, 0);
+                bvh.querySphere(center, radius, ids);
+                for (auto id : ids) {
+                    if (sphereHits(center, radius, objects[id].worldBounds)) bvhHits++;
+                }
+                bvhSphere += std::chrono::steady_clock::now() - start;
+                if (bvhHits != bruteForceHits) result.mismatches++;
+
+                bruteForceHits = bvhHits = 0;
+                start = std::chrono::steady_clock::now();
+                for (auto& object : objects) {
+                    if (segmentHits(center, to, object.worldBounds)) bruteForceHits++;
+                }
+                bruteForceRay += std::chrono::steady_clock::now() - start;
+                start = std::chrono::steady_clock::now();
+                arrayResize(ids, NoInit, 0);
+                bvh.queryRay(center, to, ids);
+                for (auto id : ids) {
+                    if (segmentHits(center, to, objects[id].worldBounds)) bvhHits++;
+                }
+                bvhRay += std::chrono::steady_clock::now() - start;
+                if (bvhHits != bruteForceHits) result.mismatches++;
+            }
+        }
+
+        const Double frames = Math::max(frameCount, 1u);
+        const Double queries = frames * Math::max(QueriesPerFrame, 1u);
+        result.bruteForceMilliseconds = bruteForce.count() / frames;
+        result.bvhMilliseconds = bvhTotal.count() / frames;
+        result.refitMilliseconds = refit.count() / frames;
+        result.bruteForceSphereMicroseconds = bruteForceSphere.count() * 1000.0 / queries;
+        result.bvhSphereMicroseconds = bvhSphere.count() * 1000.0 / queries;
+        result.bruteForceRayMicroseconds = bruteForceRay.count() * 1000.0 / queries;
+        result.bvhRayMicroseconds = bvhRay.count() * 1000.0 / queries;
+        result.averageVisible /= frames;
+        result.averageCandidates /= frames;
+        return result;
+    }
+}
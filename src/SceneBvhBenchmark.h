@@ -0,0 +1,46 @@
+#pragma once
+
+#include "MagnumGameCommon.h"
+
+namespace MagnumGame {
+
+    /**
+     * @brief Compares testing every object against the views with a SceneBvh
+     *
+     * Lays boxes out over a level sized area, a part of them moving every
+     * frame, and finds those in a camera frustum and four shadow cascade like
+     * orthographic frusta without their near plane, like GameState does:
+     * once by transforming and testing every box for every view, once by
+     * refitting the moved boxes in a SceneBvh, querying it and testing only
+     * the candidates. Also times sphere and ray queries against a loop over
+     * all boxes. Holds no GL state, it's run from the headless simulation.
+     */
+    class SceneBvhBenchmark {
+    public:
+        /* Of the boxes, moving every frame */
+        inline static Float DynamicFraction = 0.1f;
+        /* Sphere and ray queries each frame */
+        inline static UnsignedInt QueriesPerFrame = 16;
+
+        struct Result {
+            /* Per frame, all views */
+            Double bruteForceMilliseconds;
+            Double bvhMilliseconds;
+            /* Per frame, included in bvhMilliseconds */
+            Double refitMilliseconds;
+            /* Per query */
+            Double bruteForceSphereMicroseconds;
+            Double bvhSphereMicroseconds;
+            Double bruteForceRayMicroseconds;
+            Double bvhRayMicroseconds;
+            /* Per frame, summed over the views */
+            Double averageVisible;
+            Double averageCandidates;
+            /* Views, spheres and rays where the two disagree, should be 0 */
+            UnsignedInt mismatches;
+        };
+
+        /* Average over @p frameCount frames with @p objectCount boxes */
+        static Result run(UnsignedInt objectCount, UnsignedInt frameCount);
+    };
+}
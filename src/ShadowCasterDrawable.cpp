@@ -13,12 +13,16 @@ namespace MagnumGame {
 
 
     void ShadowCasterDrawable::draw(const Matrix4 &transformationMatrix, SceneGraph::Camera3D &camera) {
-        _shader.setTransformationMatrix(camera.projectionMatrix() * transformationMatrix);
+        _shader.setTransformationMatrix(transformationMatrix);
         CHECK_GL_ERROR();
-        if (_skinMeshDrawable.boneMatrices != nullptr) {
+        if (_skinMeshDrawable.baked != nullptr) {
             _shader.setPerVertexJointCount(_skinMeshDrawable.perVertexJointCount);
+            _shader.setBakedPlayback(*_skinMeshDrawable.baked);
             CHECK_GL_ERROR();
-            _shader.setJointMatrices(*_skinMeshDrawable.boneMatrices);
+        } else if (_skinMeshDrawable.skin != nullptr) {
+            _shader.setPerVertexJointCount(_skinMeshDrawable.perVertexJointCount);
+            CHECK_GL_ERROR();
+            _shader.setJointMatrixOffset(_skinMeshDrawable.skin->getJointOffset());
             CHECK_GL_ERROR();
         } else {
             _shader.setPerVertexJointCount(0);
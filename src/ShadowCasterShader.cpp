@@ -8,14 +8,18 @@
 #include <Magnum/GL/Renderer.h>
 #include <Magnum/GL/Context.h>
 #include <Magnum/GL/Shader.h>
+#include <Corrade/Containers/Pair.h>
+#include <Corrade/Utility/Path.h>
 
+#include "FrameUniforms.h"
+#include "JointMatrixTexture.h"
 #include "MagnumGameCommon.h"
 
 namespace MagnumGame {
 
 	using namespace Magnum::GL;
 
-ShadowCasterShader::ShadowCasterShader(const Containers::StringView &vertFilename, const Containers::StringView &fragFilename, int maxAnimationBones) {
+ShadowCasterShader::ShadowCasterShader(const Containers::StringView &vertFilename, const Containers::StringView &fragFilename, int jointMatricesPerRow, bool bakedAnimation) {
 
 	CHECK_GL_ERROR();
 
@@ -28,9 +32,13 @@ ShadowCasterShader::ShadowCasterShader(const Containers::StringView &vertFilenam
     Shader vert(version, Shader::Type::Vertex);
     Shader frag(version, Shader::Type::Fragment);
 	CHECK_GL_ERROR();
-	if (maxAnimationBones > 0) {
-		vert.addSource("#define ENABLE_MAX_ANIMATION_BONES " + std::to_string(maxAnimationBones)+"\n");
+	if (jointMatricesPerRow > 0) {
+		vert.addSource("#define JOINT_MATRICES_PER_ROW " + std::to_string(jointMatricesPerRow)+"\n");
 	}
+	if (bakedAnimation) {
+		vert.addSource("#define BAKED_ANIMATION 1\n");
+	}
+	FrameUniforms::addShaderSource(vert, Utility::Path::split(vertFilename).first());
 	vert.addFile(vertFilename);
     frag.addFile(fragFilename);
 	CHECK_GL_ERROR();
@@ -60,15 +68,29 @@ ShadowCasterShader::ShadowCasterShader(const Containers::StringView &vertFilenam
 	}
 	CHECK_GL_ERROR();
 
+	if (FrameUniforms::UseUniformBuffers) {
+		setUniformBlockBinding(uniformBlockIndex("View"), FrameUniforms::ViewBinding);
+	}
+
 	transformationMatrixUniform = uniformLocation("transformationMatrix");
+	projectionMatrixUniform = uniformLocation("projectionMatrix");
 	perVertexJointCountUniform = uniformLocation("perVertexJointCount");
-	jointMatricesUniform = uniformLocation("jointMatrices");
+	jointMatrixOffsetUniform = uniformLocation("jointMatrixOffset");
+	bakedClipOffsetUniform = uniformLocation("bakedClipOffset");
+	bakedJointCountUniform = uniformLocation("bakedJointCount");
+	bakedFrameCountUniform = uniformLocation("bakedFrameCount");
+	bakedFrameUniform = uniformLocation("bakedFrame");
+	if (bakedAnimation) {
+		setUniform(uniformLocation("bakedAnimationTexture"), BakedAnimation::TextureUnit);
+	} else if (jointMatricesPerRow > 0) {
+		setUniform(uniformLocation("jointMatrixTexture"), JointMatrixTexture::TextureUnit);
+	}
 
 	Debug{} << "\nSHADER " << vertFilename << " & " << fragFilename << "Attribute locations:position=" << Position::Location
 	<< "Uniforms:"
 	<< "transformationMatrix=" << transformationMatrixUniform
 	<< "perVertexJointCount=" << perVertexJointCountUniform
-	<< "jointMatrices=" << jointMatricesUniform;
+	<< "jointMatrixOffset=" << jointMatrixOffsetUniform;
 }
 
 }
@@ -4,6 +4,7 @@
 #include <Magnum/GL/AbstractShaderProgram.h>
 #include <Magnum/Shaders/GenericGL.h>
 
+#include "BakedAnimation.h"
 #include "MagnumGameCommon.h"
 
 namespace MagnumGame {
@@ -13,27 +14,49 @@ class ShadowCasterShader : public GL::AbstractShaderProgram {
 public:
     typedef Shaders::GenericGL3D::Position Position;
 
-    explicit ShadowCasterShader(const Containers::StringView& vertFilename, const Containers::StringView& fragFilename, int maxAnimationBones);
+    explicit ShadowCasterShader(const Containers::StringView& vertFilename, const Containers::StringView& fragFilename, int jointMatricesPerRow, bool bakedAnimation = false);
 
+    /* Relative to the camera, the projection comes from FrameUniforms */
     auto& setTransformationMatrix(const Matrix4& matrix) {
         setUniform(transformationMatrixUniform, matrix);
         return *this;
     }
 
+    /* Only without FrameUniforms::UseUniformBuffers, see FrameUniforms */
+    auto& setProjectionMatrix(const Matrix4& matrix) {
+        setUniform(projectionMatrixUniform, matrix);
+        return *this;
+    }
+
     auto& setPerVertexJointCount(UnsignedInt jointCount) {
         setUniform(perVertexJointCountUniform, jointCount);
         return *this;
     }
 
-    auto& setJointMatrices(Containers::ArrayView<const Matrix4> array) {
-        setUniform(jointMatricesUniform, array);
+    /* First matrix of the skin in the JointMatrixTexture */
+    auto& setJointMatrixOffset(UnsignedInt offset) {
+        setUniform(jointMatrixOffsetUniform, offset);
+        return *this;
+    }
+
+    /* Only with bakedAnimation, in place of setJointMatrixOffset() */
+    auto& setBakedPlayback(const BakedPlayback& playback) {
+        setUniform(bakedClipOffsetUniform, playback.clipOffset);
+        setUniform(bakedJointCountUniform, playback.jointCount);
+        setUniform(bakedFrameCountUniform, playback.frameCount);
+        setUniform(bakedFrameUniform, playback.frame);
         return *this;
     }
 
 private:
     Int transformationMatrixUniform,
+        projectionMatrixUniform,
         perVertexJointCountUniform,
-        jointMatricesUniform;
+        jointMatrixOffsetUniform,
+        bakedClipOffsetUniform,
+        bakedJointCountUniform,
+        bakedFrameCountUniform,
+        bakedFrameUniform;
 };
 
 }
@@ -6,12 +6,12 @@
 #include <Magnum/ImageView.h>
 #include <Magnum/GL/Renderer.h>
 #include <Magnum/GL/TextureArray.h>
+#include <Magnum/Math/Functions.h>
 #include <Magnum/Math/Matrix3.h>
 #include <Magnum/Math/Vector3.h>
 #include <Magnum/SceneGraph/AbstractObject.h>
 #include <Corrade/Containers/Reference.h>
 #include <algorithm>
-#include <unordered_set>
 #include <Corrade/Containers/GrowableArray.h>
 #include <Magnum/GL/PixelFormat.h>
 #include <Magnum/SceneGraph/Camera.h>
@@ -136,15 +136,67 @@ namespace MagnumGame {
         };
     }
 
-    void ShadowLight::render(SceneGraph::DrawableGroup3D &drawables) {
-        /* Compute transformations of all objects in the group relative to the camera */
-        static std::vector<std::reference_wrapper<SceneGraph::AbstractObject3D> > objects{};
-        objects.reserve(drawables.size());
-        for (size_t i = 0; i < drawables.size(); i++) {
-            objects.emplace_back(drawables[i].object());
+    void ShadowLight::render(SceneGraph::DrawableGroup3D &drawables, FrameUniforms &uniforms, const CasterQuery &query) {
+        /* Every cascade looks along the same light rotation, in its space
+           each is a box around the offset of its camera, open towards the
+           light because the near plane is moved back to whatever casts onto
+           the cascade */
+        const Matrix3x3 lightRotation = _layers[0].shadowCameraMatrix.rotation();
+        const Matrix3x3 inverseLightRotation = lightRotation.transposed();
+        Vector2 unionMin{Constants::inf()}, unionMax{-Constants::inf()};
+        Float unionFar = Constants::inf();
+        for (auto &d: _layers) {
+            d.lightSpaceOffset = inverseLightRotation * d.shadowCameraMatrix.translation();
+            d.drawNear = d.orthographicNear;
+            arrayResize(d.casters, NoInit, 0);
+            const Vector2 halfSize = d.orthographicSize * 0.5f;
+            unionMin = Math::min(unionMin, d.lightSpaceOffset.xy() - halfSize);
+            unionMax = Math::max(unionMax, d.lightSpaceOffset.xy() + halfSize);
+            unionFar = Math::min(unionFar, d.lightSpaceOffset.z() - d.orthographicFar);
+        }
+
+        /* One query for the box around all cascades */
+        arrayResize(_casters, NoInit, 0);
+        if (query) {
+            const Vector4 planes[]{
+                {lightRotation[0], -unionMin.x()},
+                {-lightRotation[0], unionMax.x()},
+                {lightRotation[1], -unionMin.y()},
+                {-lightRotation[1], unionMax.y()},
+                {lightRotation[2], -unionFar},
+            };
+            for (auto* caster : query(planes)) arrayAppend(_casters, caster);
+        } else {
+            for (size_t i = 0; i < drawables.size(); i++) {
+                arrayAppend(_casters, &static_cast<ShadowCasterDrawable &>(drawables[i]));
+            }
+        }
+
+        /* World transformation of each caster once, then its bounding
+           sphere against all cascades in one go */
+        _drawnCount = _culledCount = 0;
+        if (query) _culledCount = UnsignedInt((drawables.size() - _casters.size()) * _layers.size());
+        arrayResize(_casterTransformations, NoInit, _casters.size());
+        for (UnsignedInt casterIndex = 0; casterIndex < _casters.size(); casterIndex++) {
+            auto &caster = *_casters[casterIndex];
+            auto &transformation = _casterTransformations[casterIndex] = caster.object().absoluteTransformationMatrix();
+            const Vector3 lightSpaceCentre = inverseLightRotation * transformation.transformPoint(caster.getAABB().center());
+            const Float radius = caster.getAABBRadius();
+            for (auto &d: _layers) {
+                const Vector3 centre = lightSpaceCentre - d.lightSpaceOffset;
+                const Vector2 halfSize = d.orthographicSize * 0.5f;
+                if (Math::abs(centre.x()) > halfSize.x() + radius || Math::abs(centre.y()) > halfSize.y() + radius
+                    || -centre.z() > d.orthographicFar + radius) {
+                    _culledCount++;
+                    continue;
+                }
+                /* If this object extends in front of the near plane, extend the near plane.
+                 * We negate the z because the negative z is forward away from the camera,
+                 * but the near/far planes are measured forwards. */
+                d.drawNear = Math::min(d.drawNear, -centre.z() - radius);
+                arrayAppend(d.casters, casterIndex);
+            }
         }
-        static Containers::Array<ShadowCasterDrawable *> filteredDrawables;
-        arrayReserve(filteredDrawables, drawables.size());
 
         auto bias = Matrix4{
             {0.5f, 0.0f, 0.0f, 0.0f},
@@ -155,84 +207,28 @@ namespace MagnumGame {
 
         for (auto layer = 0u; layer < _numLayers; layer++) {
             auto &d = _layers[layer];
-            auto orthographicNear = d.orthographicNear;
-            auto orthographicFar = d.orthographicFar;
             setTransformation(d.shadowCameraMatrix);
             setClean();
-            _camera.setProjectionMatrix(
-                Matrix4::orthographicProjection(d.orthographicSize, orthographicNear, orthographicFar));
-            updateClipPlanes();
-
-            auto transformations = scene()->AbstractObject<3, Type>::transformationMatrices(
-                objects, _camera.cameraMatrix());
-            auto transformationsOutIndex = 0u;
-
-            filteredDrawables = {};
-            static std::unordered_set<int> clippedDrawables;
-            for (size_t drawableIndex = 0; drawableIndex < drawables.size(); drawableIndex++) {
-                auto &drawable = static_cast<ShadowCasterDrawable &>(drawables[drawableIndex]);
-                auto &aabb = drawable.getAABB();
-                auto radius = drawable.getAABBRadius();
-                Vector4 localCentre(aabb.center(), 1);
-                auto transform = transformations[drawableIndex];
-                Vector4 drawableCentre = transform * localCentre;
-                for (size_t clipPlaneIndex = 1; clipPlaneIndex < _clipPlanes.size(); clipPlaneIndex++) {
-                    auto distance = Math::dot(_clipPlanes[clipPlaneIndex], drawableCentre);
-                    if (distance < -radius) {
-                        clippedDrawables.erase(drawableIndex);
-                        goto next;
-                    }
-                }
-                clippedDrawables.insert(drawableIndex); {
-                    /* If this object extends in front of the near plane, extend the near plane.
-                     * We negate the z because the negative z is forward away from the camera,
-                     * but the near/far planes are measured forwards. */
-                    auto nearestPoint = -drawableCentre.z() - radius;
-                    if (nearestPoint < orthographicNear) {
-                        orthographicNear = nearestPoint;
-                    }
-                    arrayAppend(filteredDrawables, &drawable);
-                    transformations[transformationsOutIndex++] = transform;
-                }
-            next:;
-            }
+            const Matrix4 cameraMatrix = _camera.cameraMatrix();
 
             auto shadowCameraProjectionMatrix = Matrix4::orthographicProjection(
-                d.orthographicSize, orthographicNear, orthographicFar);
-            _shadowMatrices[layer] = bias * shadowCameraProjectionMatrix * _camera.cameraMatrix();
+                d.orthographicSize, d.drawNear, d.orthographicFar);
+            _shadowMatrices[layer] = bias * shadowCameraProjectionMatrix * cameraMatrix;
             _camera.setProjectionMatrix(shadowCameraProjectionMatrix);
+            uniforms.setView(1 + layer, shadowCameraProjectionMatrix);
             CHECK_GL_ERROR();
 
             d.shadowFramebuffer.clear(FramebufferClear::Depth);
             CHECK_GL_ERROR();
             d.shadowFramebuffer.bind();
             CHECK_GL_ERROR();
-            for (auto i = 0U; i != transformationsOutIndex; ++i) {
-                filteredDrawables[i]->draw(transformations[i], _camera);
+            _drawnCount += UnsignedInt(d.casters.size());
+            for (auto casterIndex : d.casters) {
+                _casters[casterIndex]->draw(cameraMatrix * _casterTransformations[casterIndex], _camera);
             }
         }
 
         defaultFramebuffer.bind();
         CHECK_GL_ERROR();
-
-        objects.clear();
-        filteredDrawables = {};
-    }
-
-    void ShadowLight::updateClipPlanes() {
-        auto pm = _camera.projectionMatrix();
-        _clipPlanes = {
-            Vector4(pm[3][0] + pm[2][0], pm[3][1] + pm[2][1], pm[3][2] + pm[2][2], pm[3][3] + pm[2][3]), // near
-            Vector4(pm[3][0] - pm[2][0], pm[3][1] - pm[2][1], pm[3][2] - pm[2][2], pm[3][3] - pm[2][3]), // far
-
-            Vector4(pm[3][0] + pm[0][0], pm[3][1] + pm[0][1], pm[3][2] + pm[0][2], pm[3][3] + pm[0][3]), // left
-            Vector4(pm[3][0] - pm[0][0], pm[3][1] - pm[0][1], pm[3][2] - pm[0][2], pm[3][3] - pm[0][3]), // right
-
-            Vector4(pm[3][0] + pm[1][0], pm[3][1] + pm[1][1], pm[3][2] + pm[1][2], pm[3][3] + pm[1][3]), // bottom
-            Vector4(pm[3][0] - pm[1][0], pm[3][1] - pm[1][1], pm[3][2] - pm[1][2], pm[3][3] - pm[1][3]), // top
-        };
-        for (auto &plane: _clipPlanes) {
-            plane *= plane.xyz().lengthInverted();
-        }
     }
 }
@@ -2,14 +2,18 @@
 
 #include <Corrade/Containers/Array.h>
 #include <Corrade/Containers/StaticArray.h>
+#include <functional>
 #include <Magnum/GL/Framebuffer.h>
 #include <Magnum/SceneGraph/Drawable.h>
 #include <Magnum/Resource.h>
 
+#include "FrameUniforms.h"
 #include "MagnumGameCommon.h"
 
 namespace MagnumGame {
 
+class ShadowCasterDrawable;
+
 class ShadowLight : public Object3D
 {
 public:
@@ -18,10 +22,23 @@ public:
 
 	void setTarget(Vector3 lightDirection, Vector3 screenDirection, const Matrix4& inverseModelViewProjection);
 	
-	void render(SceneGraph::DrawableGroup3D& drawables);
+	/* Returns the casters that may be in front of all world space planes
+	   passed to it, e.g. from a SceneBvh. Called once per render() with
+	   the box around all cascades */
+	using CasterQuery = std::function<Containers::ArrayView<ShadowCasterDrawable* const>(Containers::ArrayView<const Vector4>)>;
+
+	/* Each cascade is drawn with its projection in view 1 + its index of
+	   @p uniforms. Each caster, all of @p drawables or only those @p query
+	   returns, is transformed once and sorted into the cascades it's in,
+	   into storage kept from the previous frame */
+	void render(SceneGraph::DrawableGroup3D& drawables, FrameUniforms& uniforms, const CasterQuery& query = {});
 
 	size_t getNumLayers() const { return _layers.size(); }
 
+	/* Of the last render(), summed over the cascades */
+	UnsignedInt getDrawnCount() const { return _drawnCount; }
+	UnsignedInt getCulledCount() const { return _culledCount; }
+
 	const auto& getCutPlanes() const { return _cutPlanes; }
 
 	GL::Texture2DArray& getShadowmapTextureArray() { return *_shadowTexture; }
@@ -34,21 +51,28 @@ private:
 	Containers::Array<float> _cutPlanes{};
 	SceneGraph::Camera3D& _camera;
 
-	Containers::StaticArray<6, Vector4> _clipPlanes{};
-
 	struct ShadowLayerData {
 		GL::Framebuffer shadowFramebuffer;
 		Matrix4 shadowCameraMatrix;
 		Vector2 orthographicSize;
 		float orthographicNear, orthographicFar;
+		/* Of the camera in the light's rotation, set by render() */
+		Vector3 lightSpaceOffset;
+		/* Pulled back to the casters in front of orthographicNear */
+		float drawNear;
+		/* Indices into _casters */
+		Containers::Array<UnsignedInt> casters;
 
 		ShadowLayerData(Range2Di viewport) : shadowFramebuffer(viewport) { }
 	};
 
 	Containers::Array<ShadowLayerData> _layers{};
 	Containers::Array<Matrix4> _shadowMatrices{};
-
-	void updateClipPlanes();
+	/* Of the last render(), with a world transformation each */
+	Containers::Array<ShadowCasterDrawable*> _casters{};
+	Containers::Array<Matrix4> _casterTransformations{};
+	UnsignedInt _drawnCount{};
+	UnsignedInt _culledCount{};
 
 	Containers::StaticArray<8, Vector3> computeCameraFrustumCorners(int layer, Math::Matrix4<float> imvp);
 };
@@ -0,0 +1,107 @@
+#include "SkeletonAsset.h"
+
+#include <Corrade/Containers/GrowableArray.h>
+#include <Corrade/Containers/Optional.h>
+#include <Corrade/Utility/Algorithms.h>
+#include <Corrade/Utility/Assert.h>
+#include <Corrade/Utility/Debug.h>
+#include <Magnum/Trade/AbstractImporter.h>
+#include <Magnum/Trade/SceneData.h>
+#include <Magnum/Trade/SkinData.h>
+
+namespace MagnumGame {
+
+    SkeletonAsset::SkeletonAsset(Trade::AbstractImporter &importer) {
+        auto sceneData = importer.scene(importer.defaultScene());
+        if (!sceneData) {
+            Error{} << "Can't import the skeleton scene";
+            return;
+        }
+
+        _objectBones = Containers::Array<Int>{DirectInit, std::size_t(sceneData->mappingBound()), -1};
+
+        /* Depth-first, so parents always get a lower index than their children */
+        auto addBones = [&](auto& self, Long objectId, Int parent) -> void {
+            for (auto childId : sceneData->childrenFor(objectId)) {
+                auto bone = Int(_parents.size());
+                _objectBones[childId] = bone;
+                arrayAppend(_parents, parent);
+                arrayAppend(_depths, parent < 0 ? 0u : _depths[parent] + 1);
+                arrayAppend(_names, Containers::String{importer.objectName(childId)});
+
+                Vector3 translation;
+                Quaternion rotation;
+                Vector3 scaling{1.0f};
+                if (auto transform = sceneData->transformation3DFor(childId)) {
+                    translation = transform->translation();
+                    rotation = Quaternion::fromMatrix(transform->rotation());
+                    scaling = transform->scaling();
+                }
+                arrayAppend(_defaultTranslations, translation);
+                arrayAppend(_defaultRotations, rotation);
+                arrayAppend(_defaultScalings, scaling);
+
+                self(self, Long(childId), bone);
+            }
+        };
+        addBones(addBones, -1, -1);
+
+        for (auto skinId = 0U; skinId < importer.skin3DCount(); skinId++) {
+            auto skinData = importer.skin3D(skinId);
+            if (!skinData) continue;
+
+            auto& skin = arrayAppend(_skins, InPlaceInit);
+            skin.inverseBindMatrices = Containers::Array<Matrix4>{NoInit, skinData->inverseBindMatrices().size()};
+            Utility::copy(skinData->inverseBindMatrices(), skin.inverseBindMatrices);
+            skin.jointBones = Containers::Array<UnsignedInt>{NoInit, skinData->joints().size()};
+            for (std::size_t joint = 0; joint < skin.jointBones.size(); joint++) {
+                auto bone = getBoneForObject(skinData->joints()[joint]);
+                if (bone == -1) {
+                    Warning{} << "Skin" << skinId << "joint" << joint << "isn't in the default scene";
+                    bone = 0;
+                }
+                skin.jointBones[joint] = UnsignedInt(bone);
+            }
+        }
+
+        Debug{} << "Skeleton with" << getBoneCount() << "bones and" << _skins.size() << "skins";
+    }
+
+    SkeletonPose::SkeletonPose(const SkeletonAsset &skeleton)
+        : _skeleton{skeleton},
+          _translations{NoInit, skeleton.getBoneCount()},
+          _rotations{NoInit, skeleton.getBoneCount()},
+          _scalings{NoInit, skeleton.getBoneCount()},
+          _modelMatrices{NoInit, skeleton.getBoneCount()} {
+        resetToDefault();
+        computeModelMatrices();
+    }
+
+    void SkeletonPose::resetToDefault() {
+        Utility::copy(_skeleton.getDefaultTranslations(), _translations);
+        Utility::copy(_skeleton.getDefaultRotations(), _rotations);
+        Utility::copy(_skeleton.getDefaultScalings(), _scalings);
+    }
+
+    void SkeletonPose::computeModelMatrices() {
+        auto parents = _skeleton.getParents();
+        for (std::size_t bone = 0; bone < parents.size(); bone++) {
+            /* Same T*R*S as TranslationRotationScalingTransformation3D */
+            auto rotationScaling = _rotations[bone].toMatrix();
+            rotationScaling[0] *= _scalings[bone].x();
+            rotationScaling[1] *= _scalings[bone].y();
+            rotationScaling[2] *= _scalings[bone].z();
+            auto local = Matrix4::from(rotationScaling, _translations[bone]);
+
+            auto parent = parents[bone];
+            _modelMatrices[bone] = parent < 0 ? local : _modelMatrices[parent] * local;
+        }
+    }
+
+    void SkeletonPose::writeJointMatrices(const SkeletonAsset::Skin &skin, Containers::ArrayView<Matrix4> jointMatrices) const {
+        CORRADE_INTERNAL_ASSERT(jointMatrices.size() == skin.jointBones.size());
+        for (std::size_t joint = 0; joint < skin.jointBones.size(); joint++) {
+            jointMatrices[joint] = _modelMatrices[skin.jointBones[joint]] * skin.inverseBindMatrices[joint];
+        }
+    }
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <Corrade/Containers/Array.h>
+#include <Corrade/Containers/ArrayView.h>
+#include <Corrade/Containers/String.h>
+#include <Magnum/Math/Matrix4.h>
+#include <Magnum/Math/Quaternion.h>
+#include <Magnum/Trade/Trade.h>
+
+#include "MagnumGameCommon.h"
+
+namespace MagnumGame {
+
+    /**
+     * @brief Flattened bone hierarchy of an animated model
+     *
+     * Every object of the default scene is a bone, stored depth-first so a
+     * parent always comes before its children and model matrices are one
+     * linear pass. Holds no GL state, so it's shared with the headless
+     * simulation.
+     */
+    class SkeletonAsset {
+    public:
+        struct Skin {
+            /* Bone index of each joint */
+            Containers::Array<UnsignedInt> jointBones;
+            Containers::Array<Matrix4> inverseBindMatrices;
+        };
+
+        explicit SkeletonAsset(Trade::AbstractImporter& importer);
+
+        DISALLOW_COPY(SkeletonAsset)
+
+        UnsignedInt getBoneCount() const { return UnsignedInt(_parents.size()); }
+
+        /* Bone index of a scene object, -1 if it isn't in the default scene */
+        Int getBoneForObject(UnsignedLong objectId) const {
+            return objectId < _objectBones.size() ? _objectBones[objectId] : -1;
+        }
+
+        Containers::StringView getBoneName(UnsignedInt bone) const { return _names[bone]; }
+
+        /* Parent bone of every bone, -1 for roots, always lower than the bone's own index */
+        Containers::ArrayView<const Int> getParents() const { return _parents; }
+
+        /* Number of ancestors of every bone, 0 for roots */
+        Containers::ArrayView<const UnsignedInt> getDepths() const { return _depths; }
+
+        Containers::ArrayView<const Vector3> getDefaultTranslations() const { return _defaultTranslations; }
+        Containers::ArrayView<const Quaternion> getDefaultRotations() const { return _defaultRotations; }
+        Containers::ArrayView<const Vector3> getDefaultScalings() const { return _defaultScalings; }
+
+        const Containers::Array<Skin>& getSkins() const { return _skins; }
+
+    private:
+        Containers::Array<Int> _parents;
+        Containers::Array<UnsignedInt> _depths;
+        Containers::Array<Int> _objectBones;
+        Containers::Array<Containers::String> _names;
+        Containers::Array<Vector3> _defaultTranslations;
+        Containers::Array<Quaternion> _defaultRotations;
+        Containers::Array<Vector3> _defaultScalings;
+        Containers::Array<Skin> _skins;
+    };
+
+    /**
+     * @brief Local TRS of every bone of a skeleton, in separate arrays
+     *
+     * Animation writes the local values, computeModelMatrices() turns them
+     * into model space in one pass over the parent-first bone order and
+     * writeJointMatrices() produces what the skinning shader consumes. The
+     * arrays are allocated once, so animation tracks may bind to their
+     * elements.
+     */
+    class SkeletonPose {
+    public:
+        explicit SkeletonPose(const SkeletonAsset& skeleton);
+
+        DISALLOW_COPY(SkeletonPose)
+
+        Containers::ArrayView<Vector3> translations() { return _translations; }
+        Containers::ArrayView<Quaternion> rotations() { return _rotations; }
+        Containers::ArrayView<Vector3> scalings() { return _scalings; }
+        Containers::ArrayView<const Matrix4> modelMatrices() const { return _modelMatrices; }
+
+        void resetToDefault();
+
+        void computeModelMatrices();
+
+        /* @p jointMatrices has to be as large as the skin's joint list */
+        void writeJointMatrices(const SkeletonAsset::Skin& skin, Containers::ArrayView<Matrix4> jointMatrices) const;
+
+    private:
+        const SkeletonAsset& _skeleton;
+        Containers::Array<Vector3> _translations;
+        Containers::Array<Quaternion> _rotations;
+        Containers::Array<Vector3> _scalings;
+        Containers::Array<Matrix4> _modelMatrices;
+    };
+}
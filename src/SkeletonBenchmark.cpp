@@ -0,0 +1,238 @@
+#include "SkeletonBenchmark.h"
+
+#include <chrono>
+#include <type_traits>
+#include <Corrade/Containers/Pointer.h>
+#include <Corrade/Utility/Debug.h>
+#include <Magnum/Animation/Player.h>
+#include <Magnum/Math/CubicHermite.h>
+#include <Magnum/Math/Functions.h>
+#include <Magnum/SceneGraph/Camera.h>
+#include <Magnum/SceneGraph/Drawable.h>
+#include <Magnum/SceneGraph/Scene.h>
+#include <Magnum/SceneGraph/TranslationRotationScalingTransformation3D.h>
+#include <Magnum/Trade/AbstractImporter.h>
+
+namespace MagnumGame {
+
+    namespace {
+        typedef Animation::Player<std::chrono::nanoseconds, Float> AnimationPlayer;
+        typedef SceneGraph::Object<SceneGraph::TranslationRotationScalingTransformation3D> BoneObject;
+        typedef SceneGraph::Scene<SceneGraph::TranslationRotationScalingTransformation3D> BoneScene;
+
+        /* Calls @p bind with each track view and the bone it animates */
+        template<class Bind> void bindTracks(const Trade::AnimationData& animation, const SkeletonAsset& skeleton, Bind&& bind) {
+            for (UnsignedInt track = 0; track != animation.trackCount(); track++) {
+                auto bone = skeleton.getBoneForObject(animation.trackTarget(track));
+                if (bone == -1) continue;
+
+                auto target = animation.trackTargetName(track);
+                switch (animation.trackType(track)) {
+                    case Trade::AnimationTrackType::Vector3:
+                        bind(target, UnsignedInt(bone), animation.track<Vector3>(track));
+                        break;
+                    case Trade::AnimationTrackType::CubicHermite3D:
+                        bind(target, UnsignedInt(bone), animation.track<CubicHermite3D>(track));
+                        break;
+                    case Trade::AnimationTrackType::Quaternion:
+                        bind(target, UnsignedInt(bone), animation.track<Quaternion>(track));
+                        break;
+                    case Trade::AnimationTrackType::CubicHermiteQuaternion:
+                        bind(target, UnsignedInt(bone), animation.track<CubicHermiteQuaternion>(track));
+                        break;
+                    default:
+                        break;
+                }
+            }
+        }
+
+        class JointDrawable : public SceneGraph::Drawable3D {
+        public:
+            explicit JointDrawable(BoneObject &object, const Matrix4 &inverseBindMatrix, Matrix4 &jointMatrix,
+                                   SceneGraph::DrawableGroup3D &group)
+                : SceneGraph::Drawable3D{object, &group},
+                  _inverseBindMatrix{inverseBindMatrix},
+                  _jointMatrix(jointMatrix) {
+            }
+
+        private:
+            void draw(const Matrix4 &transformationMatrix, SceneGraph::Camera3D &) override {
+                _jointMatrix = transformationMatrix * _inverseBindMatrix;
+            }
+
+            Matrix4 _inverseBindMatrix;
+            Matrix4 &_jointMatrix;
+        };
+
+        struct SceneGraphCharacter {
+            BoneScene scene;
+            SceneGraph::Camera3D camera{scene};
+            SceneGraph::DrawableGroup3D joints;
+            AnimationPlayer player;
+            Containers::Array<Containers::Array<Matrix4>> jointMatrices;
+
+            SceneGraphCharacter(const SkeletonAsset& skeleton, const Trade::AnimationData& animation) {
+                Containers::Array<BoneObject*> bones{NoInit, skeleton.getBoneCount()};
+                auto parents = skeleton.getParents();
+                for (UnsignedInt bone = 0; bone < bones.size(); bone++) {
+                    auto& object = parents[bone] < 0 ? scene.addChild<BoneObject>() : bones[parents[bone]]->addChild<BoneObject>();
+                    object.setTranslation(skeleton.getDefaultTranslations()[bone]);
+                    object.setRotation(skeleton.getDefaultRotations()[bone]);
+                    object.setScaling(skeleton.getDefaultScalings()[bone]);
+                    bones[bone] = &object;
+                }
+
+                auto& skins = skeleton.getSkins();
+                jointMatrices = Containers::Array<Containers::Array<Matrix4>>{skins.size()};
+                for (std::size_t skin = 0; skin < skins.size(); skin++) {
+                    jointMatrices[skin] = Containers::Array<Matrix4>{DirectInit, skins[skin].jointBones.size(), Math::IdentityInit};
+                    for (std::size_t joint = 0; joint < skins[skin].jointBones.size(); joint++) {
+                        bones[skins[skin].jointBones[joint]]->addFeature<JointDrawable>(
+                            skins[skin].inverseBindMatrices[joint], jointMatrices[skin][joint], joints);
+                    }
+                }
+
+                bindTracks(animation, skeleton, [&](Trade::AnimationTrackTarget target, UnsignedInt bone, const auto& track) {
+                    using Result = typename std::decay_t<decltype(track)>::ResultType;
+                    if constexpr(std::is_same_v<Result, Quaternion>) {
+                        if (target == Trade::AnimationTrackTarget::Rotation3D) {
+                            player.addWithCallback(track, [](Float, const Quaternion& value, BoneObject& object) {
+                                object.setRotation(value);
+                            }, *bones[bone]);
+                        }
+                    } else {
+                        if (target == Trade::AnimationTrackTarget::Translation3D) {
+                            player.addWithCallback(track, [](Float, const Vector3& value, BoneObject& object) {
+                                object.setTranslation(value);
+                            }, *bones[bone]);
+                        } else if (target == Trade::AnimationTrackTarget::Scaling3D) {
+                            player.addWithCallback(track, [](Float, const Vector3& value, BoneObject& object) {
+                                object.setScaling(value);
+                            }, *bones[bone]);
+                        }
+                    }
+                });
+            }
+
+            void update(std::chrono::nanoseconds time) {
+                player.advance(time);
+                camera.draw(joints);
+            }
+        };
+
+        /* Either plays per-track player tracks into the pose or samples a whole
+           clip into it */
+        struct FlatCharacter {
+            SkeletonPose pose;
+            AnimationPlayer player;
+            const AnimationClip* clip;
+            Containers::Array<Containers::Array<Matrix4>> jointMatrices;
+
+            FlatCharacter(const SkeletonAsset& skeleton, const Trade::AnimationData& animation, const AnimationClip* clip): pose{skeleton}, clip{clip} {
+                auto& skins = skeleton.getSkins();
+                jointMatrices = Containers::Array<Containers::Array<Matrix4>>{skins.size()};
+                for (std::size_t skin = 0; skin < skins.size(); skin++) {
+                    jointMatrices[skin] = Containers::Array<Matrix4>{DirectInit, skins[skin].jointBones.size(), Math::IdentityInit};
+                }
+                if (clip) return;
+
+                bindTracks(animation, skeleton, [&](Trade::AnimationTrackTarget target, UnsignedInt bone, const auto& track) {
+                    using Result = typename std::decay_t<decltype(track)>::ResultType;
+                    if constexpr(std::is_same_v<Result, Quaternion>) {
+                        if (target == Trade::AnimationTrackTarget::Rotation3D) player.add(track, pose.rotations()[bone]);
+                    } else {
+                        if (target == Trade::AnimationTrackTarget::Translation3D) player.add(track, pose.translations()[bone]);
+                        else if (target == Trade::AnimationTrackTarget::Scaling3D) player.add(track, pose.scalings()[bone]);
+                    }
+                });
+            }
+
+            void update(std::chrono::nanoseconds time, const SkeletonAsset& skeleton) {
+                if (clip) clip->sampleLooped(std::chrono::duration<Float>{time}.count(), pose);
+                else player.advance(time);
+                pose.computeModelMatrices();
+                for (std::size_t skin = 0; skin < jointMatrices.size(); skin++) {
+                    pose.writeJointMatrices(skeleton.getSkins()[skin], jointMatrices[skin]);
+                }
+            }
+        };
+
+        /* Frames are spaced at 60 Hz, so the animation actually moves */
+        std::chrono::nanoseconds frameTime(UnsignedInt frame) {
+            return std::chrono::nanoseconds{Long(frame) * 1000000000 / 60};
+        }
+
+        template<class Character, class ...Args> Double timeFrames(Containers::ArrayView<Containers::Pointer<Character>> characters,
+                                                                   UnsignedInt frameCount, const Args&... args) {
+            auto start = std::chrono::steady_clock::now();
+            for (UnsignedInt frame = 0; frame < frameCount; frame++) {
+                for (auto& character : characters) character->update(frameTime(frame), args...);
+            }
+            std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+            return duration.count() * 1000.0 / Math::max(frameCount, 1u);
+        }
+
+        Float maxJointDifference(const Containers::Array<Containers::Array<Matrix4>>& expected,
+                                 const Containers::Array<Containers::Array<Matrix4>>& actual) {
+            Float maxDifference = 0.0f;
+            for (std::size_t skin = 0; skin < expected.size(); skin++) {
+                for (std::size_t joint = 0; joint < expected[skin].size(); joint++) {
+                    for (std::size_t column = 0; column < 4; column++) {
+                        auto difference = Math::abs(expected[skin][joint][column] - actual[skin][joint][column]);
+                        maxDifference = Math::max(maxDifference, difference.max());
+                    }
+                }
+            }
+            return maxDifference;
+        }
+    }
+
+    SkeletonBenchmark::SkeletonBenchmark(Trade::AbstractImporter &importer, Containers::StringView animationName)
+        : _skeleton{importer} {
+        for (UnsignedInt i = 0; i < importer.animationCount(); i++) {
+            if (importer.animationName(i) == animationName) {
+                _animation = importer.animation(i);
+                break;
+            }
+        }
+        if (!_animation) {
+            Error{} << "No animation named" << animationName;
+            return;
+        }
+        _clip.emplace(*_animation, _skeleton);
+        Debug{} << "Clip" << animationName << "has" << _clip->getTrackCount() << "tracks in"
+                << _clip->getChannelCount() << "keyframe channels";
+    }
+
+    SkeletonBenchmark::Result SkeletonBenchmark::run(UnsignedInt characterCount, UnsignedInt frameCount) const {
+        Result result{};
+
+        Containers::Array<Containers::Pointer<SceneGraphCharacter>> sceneGraphCharacters{characterCount};
+        Containers::Array<Containers::Pointer<FlatCharacter>> flatCharacters{characterCount};
+        Containers::Array<Containers::Pointer<FlatCharacter>> clipCharacters{characterCount};
+        for (UnsignedInt i = 0; i < characterCount; i++) {
+            sceneGraphCharacters[i].emplace(_skeleton, *_animation);
+            flatCharacters[i].emplace(_skeleton, *_animation, nullptr);
+            clipCharacters[i].emplace(_skeleton, *_animation, &*_clip);
+            /* Loop like Animator does, the clip loops on its own */
+            for (auto* player : {&sceneGraphCharacters[i]->player, &flatCharacters[i]->player}) {
+                player->setPlayCount(0);
+                player->play({});
+            }
+        }
+
+        result.sceneGraphMilliseconds = timeFrames<SceneGraphCharacter>(sceneGraphCharacters, frameCount);
+        result.flatMilliseconds = timeFrames<FlatCharacter>(flatCharacters, frameCount, _skeleton);
+        result.clipMilliseconds = timeFrames<FlatCharacter>(clipCharacters, frameCount, _skeleton);
+
+        /* All ended on the same frame, so the matrices should agree, the clip
+           within the difference between its nlerp and the player's slerp */
+        for (UnsignedInt i = 0; i < characterCount; i++) {
+            auto& expected = sceneGraphCharacters[i]->jointMatrices;
+            result.maxDifference = Math::max(result.maxDifference, maxJointDifference(expected, flatCharacters[i]->jointMatrices));
+            result.clipMaxDifference = Math::max(result.clipMaxDifference, maxJointDifference(expected, clipCharacters[i]->jointMatrices));
+        }
+
+        return result;
+    }
+}
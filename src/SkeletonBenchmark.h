@@ -0,0 +1,50 @@
+#pragma once
+
+#include <Corrade/Containers/Array.h>
+#include <Corrade/Containers/Optional.h>
+#include <Corrade/Containers/StringView.h>
+#include <Magnum/Trade/AnimationData.h>
+
+#include "MagnumGameCommon.h"
+#include "AnimationClip.h"
+#include "SkeletonAsset.h"
+
+namespace MagnumGame {
+
+    /**
+     * @brief Compares the flat SkeletonPose against a scene graph of bones
+     *
+     * The scene graph path is what Animator used to do: an Object per bone
+     * with a TRS transformation, animation callbacks setting them and a
+     * camera drawing a JointDrawable per joint. The flat path plays the same
+     * tracks into a SkeletonPose, the clip path samples an AnimationClip into
+     * it like Animator does now. All play the same animation on every
+     * character and end with the same joint matrices.
+     * Holds no GL state, it's run from the headless simulation.
+     */
+    class SkeletonBenchmark {
+    public:
+        struct Result {
+            Double sceneGraphMilliseconds;
+            Double flatMilliseconds;
+            Double clipMilliseconds;
+            /* Largest joint matrix element difference to the scene graph path */
+            Float maxDifference;
+            Float clipMaxDifference;
+        };
+
+        explicit SkeletonBenchmark(Trade::AbstractImporter& importer, Containers::StringView animationName);
+
+        DISALLOW_COPY(SkeletonBenchmark)
+
+        bool isValid() const { return bool(_animation); }
+
+        /* Average time to animate @p characterCount characters for one frame */
+        Result run(UnsignedInt characterCount, UnsignedInt frameCount) const;
+
+    private:
+        SkeletonAsset _skeleton;
+        Containers::Optional<Trade::AnimationData> _animation;
+        Containers::Optional<AnimationClip> _clip;
+    };
+}
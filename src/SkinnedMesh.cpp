@@ -0,0 +1,35 @@
+#include "SkinnedMesh.h"
+
+#include <Magnum/GL/TransformFeedback.h>
+
+#include "AnimationState.h"
+#include "GameShader.h"
+#include "SkinningShader.h"
+
+namespace MagnumGame {
+
+    SkinnedMesh::SkinnedMesh(AnimatorAsset::SkinningSource &source, const Skin &skin, UnsignedInt perVertexJointCount)
+        : _source{source}
+        , _skin{skin}
+        , _perVertexJointCount{perVertexJointCount}
+        , _vertices{GL::Buffer::TargetHint::Array} {
+        _vertices.setData({nullptr, source.vertexCount * sizeof(SkinningShader::SkinnedVertex)}, GL::BufferUsage::DynamicCopy);
+
+        _mesh.setPrimitive(MeshPrimitive::Triangles)
+            .setCount(Int(source.indexCount))
+            .addVertexBuffer(_vertices, 0, GameShader::Position{}, GameShader::Normal{})
+            .addVertexBuffer(source.vertices, source.textureCoordinateOffset, source.textureCoordinateStride,
+                             GL::DynamicAttribute{GameShader::TextureCoordinates{}, source.textureCoordinateFormat})
+            .setIndexBuffer(source.indices, source.indexOffset, source.indexType);
+    }
+
+    void SkinnedMesh::skin(SkinningShader &shader, GL::TransformFeedback &feedback) {
+        shader.setPerVertexJointCount(_perVertexJointCount)
+              .setJointMatrixOffset(_skin.getJointOffset());
+        feedback.attachBuffer(0, _vertices);
+        feedback.begin(shader, GL::TransformFeedback::PrimitiveMode::Points);
+        shader.draw(_source.points);
+        feedback.end();
+        CHECK_GL_ERROR();
+    }
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <Magnum/GL/Buffer.h>
+#include <Magnum/GL/Mesh.h>
+#include <Magnum/GL/GL.h>
+
+#include "AnimatorAsset.h"
+#include "MagnumGameCommon.h"
+
+namespace MagnumGame {
+    class Skin;
+    class SkinningShader;
+
+    /**
+     * @brief One character's copy of a skinned mesh, skinned once a frame
+     *
+     * skin() runs the SkinningShader over every vertex of the asset mesh
+     * and captures the skinned positions and normals into a buffer of this
+     * instance. getMesh() draws those with the asset's texture coordinates
+     * and indices, so the main pass and every shadow cascade draw it without
+     * skinning again.
+     */
+    class SkinnedMesh {
+    public:
+        explicit SkinnedMesh(AnimatorAsset::SkinningSource& source, const Skin& skin, UnsignedInt perVertexJointCount);
+
+        DISALLOW_COPY(SkinnedMesh)
+
+        GL::Mesh& getMesh() { return _mesh; }
+
+        UnsignedInt getVertexCount() const { return _source.vertexCount; }
+
+        /* Expects the JointMatrixTexture uploaded and rasterization
+           discarded */
+        void skin(SkinningShader& shader, GL::TransformFeedback& feedback);
+
+    private:
+        AnimatorAsset::SkinningSource& _source;
+        const Skin& _skin;
+        UnsignedInt _perVertexJointCount;
+        GL::Buffer _vertices;
+        GL::Mesh _mesh;
+    };
+}
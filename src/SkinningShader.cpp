@@ -0,0 +1,64 @@
+#include "SkinningShader.h"
+
+#include <iostream>
+#include <Magnum/GL/Context.h>
+#include <Magnum/GL/Shader.h>
+
+#include "JointMatrixTexture.h"
+#include "MagnumGameCommon.h"
+
+namespace MagnumGame {
+
+	using namespace Magnum::GL;
+
+SkinningShader::SkinningShader(const Containers::StringView &vertFilename, const Containers::StringView &fragFilename, int jointMatricesPerRow) {
+
+	CHECK_GL_ERROR();
+	const Version version = Context::current().version();
+
+	// Load shader sources
+    Shader vert(version, Shader::Type::Vertex);
+    Shader frag(version, Shader::Type::Fragment);
+	vert.addSource("#define JOINT_MATRICES_PER_ROW " + std::to_string(jointMatricesPerRow)+"\n");
+	vert.addFile(vertFilename);
+    frag.addFile(fragFilename);
+	CHECK_GL_ERROR();
+	Debug{} << "Compiling shader " << vertFilename << " " << fragFilename << static_cast<int>(version);
+#ifndef MAGNUM_TARGET_WEBGL
+	setLabel(vertFilename + " & " + fragFilename);
+#endif
+	vert.submitCompile();
+	frag.submitCompile();
+	if (!vert.checkCompile() || !frag.checkCompile()) {
+		throw std::runtime_error("Failed to compile " + vertFilename + " & " + fragFilename);
+	}
+	CHECK_GL_ERROR();
+
+	bindAttributeLocation(Position::Location, "position");
+	bindAttributeLocation(Normal::Location, "normal");
+	bindAttributeLocation(JointIds::Location, "jointIds");
+	bindAttributeLocation(Weights::Location, "weights");
+
+    attachShader(vert);
+    attachShader(frag);
+	setTransformFeedbackOutputs({"skinnedPosition", "skinnedNormal"}, TransformFeedbackBufferMode::InterleavedAttributes);
+	CHECK_GL_ERROR();
+
+    // Link the program together
+	std::cout.flush();
+	if (!link()) {
+		throw std::runtime_error("Failed to link " + vertFilename + " & " + fragFilename);
+	}
+	CHECK_GL_ERROR();
+
+	perVertexJointCountUniform = uniformLocation("perVertexJointCount");
+	jointMatrixOffsetUniform = uniformLocation("jointMatrixOffset");
+	setUniform(uniformLocation("jointMatrixTexture"), JointMatrixTexture::TextureUnit);
+
+	Debug{} << "\nSHADER " << vertFilename << " & " << fragFilename
+	<< "Uniforms:"
+	<< "perVertexJointCount=" << perVertexJointCountUniform
+	<< "jointMatrixOffset=" << jointMatrixOffsetUniform;
+}
+
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <Magnum/GL/AbstractShaderProgram.h>
+#include <Magnum/Shaders/GenericGL.h>
+
+#include "MagnumGameCommon.h"
+
+namespace MagnumGame {
+
+class SkinningShader : public GL::AbstractShaderProgram {
+
+public:
+    typedef Shaders::GenericGL3D::Position Position;
+    typedef Shaders::GenericGL3D::Normal Normal;
+    typedef Shaders::GenericGL3D::JointIds JointIds;
+    typedef Shaders::GenericGL3D::Weights Weights;
+
+    /* Captured interleaved into one buffer with transform feedback */
+    struct SkinnedVertex {
+        Vector3 position;
+        Vector3 normal;
+    };
+
+    explicit SkinningShader(const Containers::StringView& vertFilename, const Containers::StringView& fragFilename, int jointMatricesPerRow);
+
+    auto& setPerVertexJointCount(UnsignedInt jointCount) {
+        setUniform(perVertexJointCountUniform, jointCount);
+        return *this;
+    }
+
+    /* First matrix of the skin in the JointMatrixTexture */
+    auto& setJointMatrixOffset(UnsignedInt offset) {
+        setUniform(jointMatrixOffsetUniform, offset);
+        return *this;
+    }
+
+private:
+    Int perVertexJointCountUniform,
+        jointMatrixOffsetUniform;
+};
+
+}
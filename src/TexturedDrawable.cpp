@@ -84,22 +84,64 @@ namespace MagnumGame {
         return t;
     }
 
+    GL::AbstractShaderProgram& TexturedDrawable::getShader() const {
+        if (_phongShader) return *_phongShader;
+        return *_gameShader;
+    }
+
     void TexturedDrawable::draw(const Matrix4 &transformation, SceneGraph::Camera3D &camera) {
-        if (_color.a() <= 0.0f) return;
+        if (!isVisible()) return;
+        RenderState state;
+        submit(transformation, camera, state);
+    }
+
+    void TexturedDrawable::submit(const Matrix4 &transformation, SceneGraph::Camera3D &camera, RenderState &state) {
         CHECK_GL_ERROR();
+
+        /* The uniforms that are the same for every draw of a frame, set
+           here for PhongGL only */
+        const bool shaderChanged = state.shader != &getShader();
+        if (shaderChanged) {
+            state.shader = &getShader();
+            state.perVertexJointCount = -1;
+            state.shaderChanges++;
+        } else {
+            state.skippedChanges++;
+        }
+        if (&_mesh != state.mesh) {
+            state.mesh = &_mesh;
+            state.meshChanges++;
+        }
+        const bool bindTexture = _texture && _texture != state.texture;
+        if (bindTexture) {
+            state.texture = _texture;
+            state.textureBinds++;
+        } else if (_texture) {
+            state.skippedChanges++;
+        }
+        auto setPerVertexJointCount = [&](UnsignedInt count) {
+            if (Int(count) == state.perVertexJointCount) {
+                state.skippedChanges++;
+                return false;
+            }
+            state.perVertexJointCount = Int(count);
+            return true;
+        };
+        state.draws++;
+
         if (_phongShader) {
             auto& _shader = *_phongShader;
-            _shader.setProjectionMatrix(camera.projectionMatrix());
+            if (shaderChanged) {
+                _shader.setProjectionMatrix(camera.projectionMatrix());
+                _shader.setAmbientColor({ambientColor, ambientColor, ambientColor, 1.0f});
+                _shader.setLightColors({Color3{lightColor, lightColor, lightColor}});
+                _shader.setShininess(shininess);
+                _shader.setSpecularColor({specular, specular,specular,1.0f});
+            }
             _shader.setTransformationMatrix(transformation);
             _shader.setDiffuseColor(_color);
-            // _shader.setLightRanges({Constants::inf()});
-            _shader.setAmbientColor({ambientColor, ambientColor, ambientColor, 1.0f});
-            _shader.setLightColors({Color3{lightColor, lightColor, lightColor}});
-            _shader.setSpecularColor(_color);
-            _shader.setShininess(shininess);
-            _shader.setSpecularColor({specular, specular,specular,1.0f});
             _shader.setLightPositions({object().absoluteTransformationMatrix().inverted() * Vector4{lightDirection, 0.0f}.normalized()});
-            if (_texture) {
+            if (bindTexture) {
                 _shader.bindDiffuseTexture(*_texture);
                 CHECK_GL_ERROR();
             }
@@ -107,12 +149,13 @@ namespace MagnumGame {
                 _shader.setObjectId(_objectId);
             }
             if (_shader.flags() & Shaders::PhongGL::Flag::DynamicPerVertexJointCount) {
-                if (_skinMeshDrawable.boneMatrices != nullptr) {
+                if (_skinMeshDrawable.skin != nullptr) {
                     _shader.setPerVertexJointCount(_skinMeshDrawable.perVertexJointCount, _skinMeshDrawable.secondaryPerVertexJointCount);
+                    state.perVertexJointCount = -1;
                     CHECK_GL_ERROR();
-                    _shader.setJointMatrices(*_skinMeshDrawable.boneMatrices);
+                    _shader.setJointMatrices(_skinMeshDrawable.skin->boneMatrices());
                     CHECK_GL_ERROR();
-                } else {
+                } else if (setPerVertexJointCount(0)) {
                     _shader.setPerVertexJointCount(0, 0);
                 }
             }
@@ -122,25 +165,28 @@ namespace MagnumGame {
         }
         else if (_gameShader) {
 
+            /* The per-frame uniforms come from FrameUniforms */
             auto& _shader = *_gameShader;
-            _shader.setProjectionMatrix(camera.projectionMatrix());
             _shader.setTransformationMatrix(transformation);
             _shader.setNormalMatrix(transformation.rotation());
             _shader.setSpecularColor(_color.rgb());
             _shader.setModelMatrix(object().absoluteTransformationMatrix());
-            _shader.setLightVector(lightDirection);
-            _shader.setShininess(shininess);
-            _shader.setLightColor({lightColor, lightColor, lightColor});
-            _shader.setAmbientColor({ambientColor, ambientColor, ambientColor});
-            if (_texture) {
+            if (bindTexture) {
                 _shader.setDiffuseTexture(*_texture);
                 CHECK_GL_ERROR();
             }
-            if (_skinMeshDrawable.boneMatrices != nullptr) {
-                _shader.setPerVertexJointCount(_skinMeshDrawable.perVertexJointCount);
+            if (_skinMeshDrawable.baked != nullptr) {
+                if (setPerVertexJointCount(_skinMeshDrawable.perVertexJointCount)) {
+                    _shader.setPerVertexJointCount(_skinMeshDrawable.perVertexJointCount);
+                }
+                _shader.setBakedPlayback(*_skinMeshDrawable.baked);
+            } else if (_skinMeshDrawable.skin != nullptr) {
+                if (setPerVertexJointCount(_skinMeshDrawable.perVertexJointCount)) {
+                    _shader.setPerVertexJointCount(_skinMeshDrawable.perVertexJointCount);
+                }
                 CHECK_GL_ERROR();
-                _shader.setJointMatrices(*_skinMeshDrawable.boneMatrices);
-            } else {
+                _shader.setJointMatrixOffset(_skinMeshDrawable.skin->getJointOffset());
+            } else if (setPerVertexJointCount(0)) {
                 _shader.setPerVertexJointCount(0);
             }
             CHECK_GL_ERROR();
@@ -177,12 +223,16 @@ namespace MagnumGame {
 
     void TexturedDrawable::setSkin(Skin &skin, UnsignedInt perVertexJointCount,
                                    UnsignedInt secondaryPerVertexJointCount) {
-        Debug{} << "TexturedDrawable setSkin boneMatrices" << &skin.boneMatrices() << "data @" << skin.boneMatrices().
-                data() << "size" << skin.boneMatrices().size();
         _skinMeshDrawable = {
-            &skin.boneMatrices(),
+            &skin,
             perVertexJointCount,
             secondaryPerVertexJointCount
         };
     }
+
+    void TexturedDrawable::setBakedSkin(const BakedPlayback &playback, UnsignedInt perVertexJointCount) {
+        _skinMeshDrawable = {};
+        _skinMeshDrawable.baked = &playback;
+        _skinMeshDrawable.perVertexJointCount = perVertexJointCount;
+    }
 }
@@ -6,6 +6,7 @@
 
 #include <Corrade/Containers/Optional.h>
 #include <Magnum/Math/Color.h>
+#include <Magnum/Math/Range.h>
 #include <Magnum/Trade/Trade.h>
 #include <Magnum/GL/GL.h>
 #include <Magnum/GL/Texture.h>
@@ -13,6 +14,7 @@
 
 #include "Animator.h"
 #include "IEnableDrawable.h"
+#include "RenderQueue.h"
 
 
 namespace MagnumGame {
@@ -55,8 +57,26 @@ namespace MagnumGame {
 
         void setSkin(Skin& skin, UnsignedInt perVertexJointCount, UnsignedInt secondaryPerVertexJointCount);
 
+        /* Needs a GameShader with bakedAnimation */
+        void setBakedSkin(const BakedPlayback& playback, UnsignedInt perVertexJointCount);
+
         GL::Mesh& getMesh() const { return _mesh;}
 
+        GL::Texture2D* getTexture() const { return _texture; }
+
+        /* Local bounds of the mesh, drawables without are never culled */
+        TexturedDrawable& setBounds(const Range3D& bounds) { _bounds = bounds; _hasBounds = true; return *this; }
+        bool hasBounds() const { return _hasBounds; }
+        const Range3D& getBounds() const { return _bounds; }
+
+        GL::AbstractShaderProgram& getShader() const;
+
+        /* False once faded out with setEnabled() */
+        bool isVisible() const { return _color.a() > 0.0f; }
+
+        /* Draws with what @p state says is set up already, updating it */
+        void submit(const Matrix4 &transformation, SceneGraph::Camera3D &camera, RenderState &state);
+
         SkinMeshDrawable getSkinMeshDrawable() const { return _skinMeshDrawable; }
 
         static inline float ambientColor = 0.5f;
@@ -79,6 +99,8 @@ namespace MagnumGame {
 
         UnsignedInt _objectId{};
         SkinMeshDrawable _skinMeshDrawable{};
+        Range3D _bounds;
+        bool _hasBounds{};
     };
 
 }
@@ -30,9 +30,17 @@ namespace MagnumGame {
         arrayAppend(tweakableValues, tweakable_values);
     }
 
+    Tweakables::DebugMode::DebugMode(const char *mode_name, std::function<std::string()> info_text)
+        : modeName(mode_name),
+          infoText(std::move(info_text)) {
+    }
+
     void Tweakables::DebugMode::printTweakables(std::ostringstream &os) const {
         Debug debug{&os};
         debug << modeName;
+        if (infoText) {
+            debug << Debug::newline << infoText().c_str();
+        }
         for (size_t tweakableIndex = 0; tweakableIndex < tweakableValues.size(); tweakableIndex++) {
             auto &tweakableValue = tweakableValues[tweakableIndex];
             debug << Debug::newline << tweakableValue.name << tweakableValue.get();
@@ -46,6 +54,10 @@ namespace MagnumGame {
         arrayAppend(_debugModes, InPlaceInit, modeName, initialIndex, tweakableValues);
     }
 
+    void Tweakables::addDebugMode(const char *modeName, std::function<std::string()> infoText) {
+        arrayAppend(_debugModes, InPlaceInit, modeName, std::move(infoText));
+    }
+
     std::string Tweakables::getDebugText() const {
         std::string debugText;
         auto &debugMode = currentDebugMode();
@@ -56,6 +56,9 @@ namespace MagnumGame {
             explicit DebugMode(const char *mode_name, size_t current_tweak_index,
                 std::initializer_list<TweakableValue> tweakable_values);
 
+            /* Read-only mode showing whatever @p info_text returns each frame */
+            explicit DebugMode(const char *mode_name, std::function<std::string()> info_text);
+
             const char* getModeName() const { return modeName; }
 
             TweakableValue &currentTweaker() {
@@ -79,6 +82,7 @@ namespace MagnumGame {
             const char *modeName;
             size_t currentTweakIndex = 0;
             Containers::Array<TweakableValue> tweakableValues;
+            std::function<std::string()> infoText;
 
         };
 
@@ -87,6 +91,7 @@ namespace MagnumGame {
         bool hasActiveDebugMode() const { return _currentDebugModeIndex > 0; }
 
         void addDebugMode(const char *modeName, size_t initialIndex, std::initializer_list<TweakableValue> tweakableValues);
+        void addDebugMode(const char *modeName, std::function<std::string()> infoText);
 
         void printTweakables(const DebugMode &debugMode, std::ostringstream os) const;
 